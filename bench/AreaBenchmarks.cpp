@@ -0,0 +1,115 @@
+#include "Benchmark.h"
+#include "FigureUtils.h"
+#include "FigureCollection.h"
+#include "Rhombus.h"
+#include "Pentagon.h"
+#include "Hexagon.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+
+namespace {
+
+Array<std::shared_ptr<Figure<double>>> makeMixedFigures(size_t n){
+    Array<std::shared_ptr<Figure<double>>> figures;
+    figures.reserve(n);
+    for (size_t i = 0; i < n; ++i){
+        double size = 1.0 + static_cast<double>(i % 97);
+        switch (i % 3){
+            case 0: figures.push_back(std::make_shared<Rhombus<double>>(size, size, 0.0, 0.0)); break;
+            case 1: figures.push_back(std::make_shared<Pentagon<double>>(size, 0.0, 0.0)); break;
+            default: figures.push_back(std::make_shared<Hexagon<double>>(size, 0.0, 0.0)); break;
+        }
+    }
+    return figures;
+}
+
+}
+
+BENCHMARK(total_area){
+    for (size_t n = 1000; n <= std::min<size_t>(10000000, benchmarkMaxSize()); n *= 10){
+        auto figures = makeMixedFigures(n);
+        reportResult("total_area", "serial", n, measureSeconds([&]{
+            doNotOptimize(calculateTotalArea(figures));
+        }));
+        reportResult("total_area", "parallel", n, measureSeconds([&]{
+            doNotOptimize(calculateTotalAreaParallel(figures));
+        }));
+    }
+}
+
+BENCHMARK(total_area_parallel_scaling){
+    const size_t n = std::min<size_t>(4000000, benchmarkMaxSize());
+    auto figures = makeMixedFigures(n);
+    reportResult("total_area_parallel_scaling", "serial", n, measureSeconds([&]{
+        doNotOptimize(calculateTotalArea(figures));
+    }));
+    unsigned max_threads = defaultThreadCount();
+    for (unsigned threads = 1;; threads = std::min(threads * 2, max_threads)){
+        double time = measureSeconds([&]{
+            doNotOptimize(calculateTotalAreaParallel(figures, threads));
+        });
+        reportResult("total_area_parallel_scaling", "threads=" + std::to_string(threads), n, time);
+        if (threads == max_threads){
+            break;
+        }
+    }
+}
+
+BENCHMARK(rank_by_area){
+    const size_t n = std::min<size_t>(1000000, benchmarkMaxSize());
+    const size_t k = 100;
+    auto figures = makeMixedFigures(n);
+    auto byArea = [](const std::shared_ptr<Figure<double>> &a, const std::shared_ptr<Figure<double>> &b){
+        return a->calculateArea() < b->calculateArea();
+    };
+    reportResult("rank_by_area", "sort_virtual_comparator", n, measureSeconds([&]{ return figures; }, [&](auto &copy){
+        std::sort(copy.begin(), copy.end(), byArea);
+        doNotOptimize(copy.begin());
+    }, 3));
+    reportResult("rank_by_area", "sort_cached_keys_1_thread", n, measureSeconds([&]{
+        doNotOptimize(sortedByArea(figures, 1).size());
+    }, 3));
+    reportResult("rank_by_area", "sort_cached_keys_parallel", n, measureSeconds([&]{
+        doNotOptimize(sortedByArea(figures).size());
+    }, 3));
+    reportResult("rank_by_area", "top100_partial_sort_virtual", n, measureSeconds([&]{ return figures; }, [&](auto &copy){
+        std::partial_sort(copy.begin(), copy.begin() + k, copy.end(), [&](const auto &a, const auto &b){ return byArea(b, a); });
+        doNotOptimize(copy.begin());
+    }, 3));
+    reportResult("rank_by_area", "top100_cached_keys", n, measureSeconds([&]{
+        doNotOptimize(largestByArea(figures, k).size());
+    }, 3));
+}
+
+// Batches of 10 removals and 10 insertions, each followed by a total area
+// query, against collections of n figures.
+BENCHMARK(incremental_aggregates){
+    constexpr size_t BATCHES = 100;
+    constexpr size_t BATCH = 10;
+    for (size_t n = 1000; n <= std::min<size_t>(1000000, benchmarkMaxSize()); n *= 10){
+        auto incoming = makeMixedFigures(BATCHES * BATCH);
+        reportResult("incremental_aggregates", "array_recompute", n, measureSeconds([n]{ return makeMixedFigures(n); }, [&](auto &figures){
+            double sum = 0.0;
+            for (size_t batch = 0; batch < BATCHES; ++batch){
+                for (size_t i = 0; i < BATCH; ++i){
+                    figures.swap_remove(figures.size() / 2);
+                    figures.push_back(incoming[batch * BATCH + i]);
+                }
+                sum += calculateTotalArea(figures);
+            }
+            doNotOptimize(sum);
+        }, 3));
+        reportResult("incremental_aggregates", "figure_collection", n, measureSeconds([n]{ return FigureCollection<double>(makeMixedFigures(n)); }, [&](auto &collection){
+            double sum = 0.0;
+            for (size_t batch = 0; batch < BATCHES; ++batch){
+                for (size_t i = 0; i < BATCH; ++i){
+                    collection.swap_remove(collection.size() / 2);
+                    collection.push_back(incoming[batch * BATCH + i]);
+                }
+                sum += collection.totalArea() + collection.extent().maxX + collection.centroid().x();
+            }
+            doNotOptimize(sum);
+        }, 3));
+    }
+}
@@ -0,0 +1,275 @@
+#include "Benchmark.h"
+#include "Array.h"
+#include "FigureUtils.h"
+#include "ShardedArray.h"
+#include "Rhombus.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+Array<std::shared_ptr<Figure<double>>> makeRhombuses(size_t n){
+    Array<std::shared_ptr<Figure<double>>> figures;
+    figures.reserve(n);
+    for (size_t i = 0; i < n; ++i){
+        double d = static_cast<double>(i % 10 + 1);
+        figures.push_back(std::make_shared<Rhombus<double>>(d, d, 0.0, 0.0));
+    }
+    return figures;
+}
+
+template<typename Container>
+Container makeSequence(size_t n){
+    Container values;
+    values.reserve(n);
+    for (size_t i = 0; i < n; ++i){
+        values.push_back(static_cast<double>(i));
+    }
+    return values;
+}
+
+// push_back growth, copy, remove and iteration of one container type.
+template<typename Container>
+void benchmarkSequence(const std::string &variant){
+    for (size_t n = 1000; n <= std::min<size_t>(10000000, benchmarkMaxSize()); n *= 10){
+        reportResult("sequence_push_back", variant, n, measureSeconds([n]{
+            Container values;
+            for (size_t i = 0; i < n; ++i){
+                values.push_back(static_cast<double>(i));
+            }
+            doNotOptimize(values.size());
+        }));
+        auto values = makeSequence<Container>(n);
+        reportResult("sequence_copy", variant, n, measureSeconds([&values]{
+            Container copy(values);
+            doNotOptimize(copy.size());
+        }));
+        reportResult("sequence_iterate_index", variant, n, measureSeconds([&values, n]{
+            double sum = 0.0;
+            for (size_t i = 0; i < n; ++i){
+                sum += values[i];
+            }
+            doNotOptimize(sum);
+        }));
+        reportResult("sequence_iterate_range", variant, n, measureSeconds([&values]{
+            double sum = 0.0;
+            for (double value : values){
+                sum += value;
+            }
+            doNotOptimize(sum);
+        }));
+        // Removing from the middle is quadratic; keep it to small inputs.
+        if (n <= 100000){
+            reportResult("sequence_remove_middle", variant, n / 2, measureSeconds([n]{ return makeSequence<Container>(n); },
+                [n](Container &values){
+                    for (size_t i = 0; i < n / 2; ++i){
+                        if constexpr (requires{ values.remove(size_t(0)); }){
+                            values.remove(values.size() / 2);
+                        } else {
+                            values.erase(values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2));
+                        }
+                    }
+                    doNotOptimize(values.size());
+                }, 3));
+        }
+    }
+}
+
+// Holds a figure pointer like the Array elements do, but is not marked
+// trivially relocatable: growth and removal take the element by element
+// move path (move, then destroy the moved-from source).
+struct ElementwiseFigurePtr{
+    std::shared_ptr<Figure<double>> figure;
+
+    explicit ElementwiseFigurePtr(std::shared_ptr<Figure<double>> value) : figure(std::move(value)){}
+};
+
+template<typename Element>
+void benchmarkRelocation(const std::string &variant){
+    auto figure = std::make_shared<Rhombus<double>>(1.0, 1.0, 0.0, 0.0);
+    for (size_t n = 1000; n <= std::min<size_t>(1000000, benchmarkMaxSize()); n *= 10){
+        reportResult("relocation_growth", variant, n, measureSeconds([n, &figure]{
+            Array<Element> values;
+            for (size_t i = 0; i < n; ++i){
+                values.emplace_back(figure);
+            }
+            doNotOptimize(values.begin());
+        }));
+        if (n <= 100000){
+            reportResult("relocation_remove_front", variant, n / 10, measureSeconds([n, &figure]{
+                Array<Element> values;
+                values.reserve(n);
+                for (size_t i = 0; i < n; ++i){
+                    values.emplace_back(figure);
+                }
+                return values;
+            }, [n](Array<Element> &values){
+                for (size_t i = 0; i < n / 10; ++i){
+                    values.remove(0);
+                }
+                doNotOptimize(values.begin());
+            }, 3));
+        }
+    }
+}
+
+// Splits figures between producers, each appending its share to a fresh
+// State through add(state, begin, end). Times the run until all have joined.
+template<typename State, typename Add>
+double runProducers(const Array<std::shared_ptr<Figure<double>>> &figures, size_t producers, Add add){
+    return measureSeconds([]{ return std::make_unique<State>(); }, [&](std::unique_ptr<State> &state){
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p){
+            threads.emplace_back([&, p]{
+                add(*state, figures.size() * p / producers, figures.size() * (p + 1) / producers);
+            });
+        }
+        for (auto &thread : threads){
+            thread.join();
+        }
+        doNotOptimize(state.get());
+    }, 3);
+}
+
+struct GuardedArray{
+    std::mutex mutex;
+    Array<std::shared_ptr<Figure<double>>> figures;
+};
+
+using ShardedFigures = ShardedArray<std::shared_ptr<Figure<double>>>;
+
+// Drops every figure with area below 25 (half of the input).
+constexpr double PRUNE_THRESHOLD = 25.0;
+
+}
+
+BENCHMARK(array_prune_by_area){
+    for (size_t n = 1000; n <= std::min<size_t>(1000000, benchmarkMaxSize()); n *= 10){
+        auto setup = [n]{ return makeRhombuses(n); };
+        double erase_if_time = measureSeconds(setup, [](auto &figures){
+            doNotOptimize(removeFiguresBelowArea(figures, PRUNE_THRESHOLD));
+        });
+        reportResult("array_prune_by_area", "erase_if", n, erase_if_time);
+
+        if (n <= 100000){
+            double remove_time = measureSeconds(setup, [](auto &figures){
+                for (size_t i = figures.size(); i-- > 0;){
+                    if (figures[i]->calculateArea() < PRUNE_THRESHOLD){
+                        figures.remove(i);
+                    }
+                }
+                doNotOptimize(figures.size());
+            }, 3);
+            reportResult("array_prune_by_area", "remove_loop", n, remove_time);
+        }
+    }
+}
+
+BENCHMARK(array_swap_remove){
+    for (size_t n = 1000; n <= std::min<size_t>(1000000, benchmarkMaxSize()); n *= 10){
+        double time = measureSeconds([n]{ return makeRhombuses(n); }, [](auto &figures){
+            while (!figures.empty()){
+                figures.swap_remove(0);
+            }
+        });
+        reportResult("array_swap_remove", "drain_front", n, time);
+    }
+}
+
+BENCHMARK(array_vs_vector){
+    benchmarkSequence<Array<double>>("Array");
+    benchmarkSequence<std::vector<double>>("std::vector");
+}
+
+BENCHMARK(deduplicate_figures){
+    for (size_t n = 1000; n <= std::min<size_t>(1000000, benchmarkMaxSize()); n *= 10){
+        // Every figure appears twice.
+        auto setup = [n]{
+            Array<std::shared_ptr<Figure<double>>> figures;
+            figures.reserve(n);
+            for (size_t i = 0; i < n; ++i){
+                double d = static_cast<double>(i % (n / 2) + 1);
+                figures.push_back(std::make_shared<Rhombus<double>>(d, d, 0.0, 0.0));
+            }
+            return figures;
+        };
+        reportResult("deduplicate_figures", "hash", n, measureSeconds(setup, [](auto &figures){
+            doNotOptimize(removeDuplicateFigures(figures));
+        }));
+        if (n <= 10000){
+            reportResult("deduplicate_figures", "pairwise_is_equal", n, measureSeconds(setup, [](auto &figures){
+                Array<std::shared_ptr<Figure<double>>> unique;
+                for (const auto &figure : figures){
+                    bool seen = false;
+                    for (const auto &kept : unique){
+                        if (kept->isEqual(*figure)){
+                            seen = true;
+                            break;
+                        }
+                    }
+                    if (!seen){
+                        unique.push_back(figure);
+                    }
+                }
+                doNotOptimize(unique.size());
+            }, 3));
+        }
+    }
+}
+
+BENCHMARK(relocation){
+    benchmarkRelocation<ElementwiseFigurePtr>("elementwise_move");
+    benchmarkRelocation<std::shared_ptr<Figure<double>>>("trivially_relocatable");
+}
+
+BENCHMARK(concurrent_append){
+    size_t n = std::min<size_t>(1000000, benchmarkMaxSize());
+    auto figures = makeRhombuses(n);
+    size_t max_producers = std::max<size_t>(8, defaultThreadCount());
+    for (size_t producers = 1; producers <= max_producers; producers *= 2){
+        std::string suffix = "_" + std::to_string(producers) + "_producers";
+        // The previous way: every producer funnels into one guarded Array.
+        reportResult("concurrent_append", "mutex_array" + suffix, n, runProducers<GuardedArray>(figures, producers, [&](GuardedArray &guarded, size_t begin, size_t end){
+            for (size_t i = begin; i < end; ++i){
+                std::lock_guard<std::mutex> lock(guarded.mutex);
+                guarded.figures.push_back(figures[i]);
+            }
+        }));
+        reportResult("concurrent_append", "sharded_push_back" + suffix, n, runProducers<ShardedFigures>(figures, producers, [&](ShardedFigures &sharded, size_t begin, size_t end){
+            for (size_t i = begin; i < end; ++i){
+                sharded.push_back(figures[i]);
+            }
+        }));
+        reportResult("concurrent_append", "sharded_writer" + suffix, n, runProducers<ShardedFigures>(figures, producers, [&](ShardedFigures &sharded, size_t begin, size_t end){
+            auto writer = sharded.writer();
+            for (size_t i = begin; i < end; ++i){
+                writer.push_back(figures[i]);
+            }
+        }));
+        reportResult("concurrent_append", "seal" + suffix, n, measureSeconds([&]{
+            auto sharded = std::make_unique<ShardedFigures>();
+            std::vector<std::thread> threads;
+            for (size_t p = 0; p < producers; ++p){
+                threads.emplace_back([&, p]{
+                    auto writer = sharded->writer();
+                    for (size_t i = n * p / producers; i < n * (p + 1) / producers; ++i){
+                        writer.push_back(figures[i]);
+                    }
+                });
+            }
+            for (auto &thread : threads){
+                thread.join();
+            }
+            // The sealed Array is kept in the state so freeing it is not timed.
+            return std::make_pair(std::move(sharded), Array<std::shared_ptr<Figure<double>>>());
+        }, [](auto &state){
+            state.second = state.first->seal();
+            doNotOptimize(state.second.size());
+        }, 3));
+    }
+}
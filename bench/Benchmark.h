@@ -0,0 +1,73 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Minimal self-contained timing harness. Each result is printed as one CSV
+// line (benchmark,variant,n,seconds,ns_per_item) so runs can be diffed.
+using BenchmarkFunction = void (*)();
+
+struct BenchmarkCase{
+    const char *name;
+    BenchmarkFunction function;
+};
+
+inline std::vector<BenchmarkCase> &benchmarkRegistry(){
+    static std::vector<BenchmarkCase> registry;
+    return registry;
+}
+
+struct BenchmarkRegistrar{
+    BenchmarkRegistrar(const char *name, BenchmarkFunction function){
+        benchmarkRegistry().push_back({name, function});
+    }
+};
+
+#define BENCHMARK(name) \
+    static void name(); \
+    static BenchmarkRegistrar name##_registrar(#name, name); \
+    static void name()
+
+// Largest input size a benchmark should build; set from the command line so
+// the suite can be trimmed on small machines.
+inline size_t &benchmarkMaxSize(){
+    static size_t limit = 10000000;
+    return limit;
+}
+
+template<typename T>
+inline void doNotOptimize(const T &value){
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Best-of-repeats wall time of run(state); setup() builds a fresh state for
+// every repeat and is not timed.
+template<typename Setup, typename Run>
+double measureSeconds(Setup &&setup, Run &&run, int repeats = 5){
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < repeats; ++i){
+        auto state = setup();
+        auto start = std::chrono::steady_clock::now();
+        run(state);
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+template<typename Run>
+double measureSeconds(Run &&run, int repeats = 5){
+    return measureSeconds([]{ return 0; }, [&run](int){ run(); }, repeats);
+}
+
+inline void reportResult(const std::string &benchmark, const std::string &variant, size_t n, double seconds){
+    std::cout << benchmark << ',' << variant << ',' << n << ',' << seconds << ','
+              << (n > 0 ? seconds * 1e9 / static_cast<double>(n) : 0.0) << std::endl;
+}
+
+#endif
@@ -0,0 +1,205 @@
+#include "Benchmark.h"
+#include "FigureStore.h"
+#include "FigureUtils.h"
+#include "CachedFigure.h"
+#include "Collision.h"
+#include "Rhombus.h"
+#include "Pentagon.h"
+#include "Hexagon.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+FigureStore<double> makeStore(size_t n){
+    FigureStore<double> store;
+    for (size_t i = 0; i < n; ++i){
+        double size = 1.0 + static_cast<double>(i % 97);
+        double x = static_cast<double>(i % 1000), y = static_cast<double>(i / 1000);
+        switch (i % 3){
+            case 0: store.addRhombus(size, size, x, y); break;
+            case 1: store.addPentagon(size, x, y); break;
+            default: store.addHexagon(size, x, y); break;
+        }
+    }
+    return store;
+}
+
+Array<std::shared_ptr<Figure<double>>> toFigures(const FigureStore<double> &store){
+    Array<std::shared_ptr<Figure<double>>> figures;
+    const auto &r = store.rhombuses();
+    for (size_t i = 0; i < store.rhombusCount(); ++i){
+        figures.push_back(std::make_shared<Rhombus<double>>(r.diagonal1[i], r.diagonal2[i], r.x[i], r.y[i]));
+    }
+    const auto &p = store.pentagons();
+    for (size_t i = 0; i < store.pentagonCount(); ++i){
+        figures.push_back(std::make_shared<Pentagon<double>>(p.side[i], p.x[i], p.y[i]));
+    }
+    const auto &h = store.hexagons();
+    for (size_t i = 0; i < store.hexagonCount(); ++i){
+        figures.push_back(std::make_shared<Hexagon<double>>(h.side[i], h.x[i], h.y[i]));
+    }
+    return figures;
+}
+
+// Heap-allocating getVertices() against writeVertices() into a stack buffer.
+void benchmarkVertices(const char *shape, const Figure<double> &base, size_t n){
+    reportResult(std::string("get_vertices_") + shape, "get_vertices", n, measureSeconds([&]{
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i){
+            sum += base.getVertices().back()->x();
+        }
+        doNotOptimize(sum);
+    }, 3));
+    reportResult(std::string("get_vertices_") + shape, "write_vertices", n, measureSeconds([&]{
+        Point<double> vertices[Figure<double>::MAX_VERTICES];
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i){
+            sum += vertices[base.writeVertices(vertices) - 1].x();
+        }
+        doNotOptimize(sum);
+    }, 3));
+}
+
+// Random scene with a few overlaps per figure on average.
+Array<std::shared_ptr<Figure<double>>> makeScene(size_t n){
+    std::mt19937 rng(7);
+    double extent = std::sqrt(static_cast<double>(n)) * 4.0;
+    std::uniform_real_distribution<double> position(0.0, extent);
+    std::uniform_real_distribution<double> size(1.0, 3.0);
+    Array<std::shared_ptr<Figure<double>>> figures;
+    figures.reserve(n);
+    for (size_t i = 0; i < n; ++i){
+        double x = position(rng), y = position(rng);
+        switch (i % 3){
+            case 0: figures.push_back(std::make_shared<Rhombus<double>>(size(rng), size(rng), x, y)); break;
+            case 1: figures.push_back(std::make_shared<Pentagon<double>>(size(rng), x, y)); break;
+            default: figures.push_back(std::make_shared<Hexagon<double>>(size(rng), x, y)); break;
+        }
+    }
+    return figures;
+}
+
+}
+
+BENCHMARK(get_vertices){
+    const size_t n = std::min<size_t>(1000000, benchmarkMaxSize());
+    benchmarkVertices("rhombus", Rhombus<double>(3.0, 4.0, 1.0, 2.0), n);
+    benchmarkVertices("pentagon", Pentagon<double>(3.0, 1.0, 2.0), n);
+    benchmarkVertices("hexagon", Hexagon<double>(3.0, 1.0, 2.0), n);
+}
+
+BENCHMARK(bounding_boxes){
+    const size_t n = std::min<size_t>(1000000, benchmarkMaxSize());
+    auto store = makeStore(n);
+    auto figures = toFigures(store);
+    std::vector<double> out(n * BOUNDING_BOX_STRIDE);
+
+    reportResult("bounding_boxes", "from_get_vertices", n, measureSeconds([&]{
+        for (size_t i = 0; i < n; ++i){
+            BoundingBox box;
+            for (const auto &vertex : figures[i]->getVertices()){
+                box.expand(vertex->x(), vertex->y());
+            }
+            out[i * BOUNDING_BOX_STRIDE] = box.minX;
+        }
+        doNotOptimize(out.data());
+    }, 3));
+    reportResult("bounding_boxes", "virtual_closed_form", n, measureSeconds([&]{
+        writeBoundingBoxes(figures, out.data());
+        doNotOptimize(out.data());
+    }));
+    reportResult("bounding_boxes", "columnar_store", n, measureSeconds([&]{
+        store.writeBoundingBoxes(out.data());
+        doNotOptimize(out.data());
+    }));
+}
+
+// Reporting pattern: area and vertices asked for several times per figure.
+// The cache only saves the vertex computation, which for double shapes is a
+// few multiply-adds; it pays off for integer and float shapes, where every
+// query also converts each coordinate back from double.
+template<typename Scalar, typename Shape>
+void benchmarkCachedFigure(const char *plain_variant, const char *cached_variant){
+    const size_t total = 800000;
+    for (size_t n = 1000; n <= std::min<size_t>(100000, benchmarkMaxSize()); n *= 100){
+        const size_t queries = total / n;
+        std::string suffix = "_" + std::to_string(n) + "_figures";
+        auto run = [&](const char *variant, const auto &figures){
+            reportResult("cached_figure", variant + suffix, n * queries, measureSeconds([&]{
+                Point<Scalar> vertices[Figure<Scalar>::MAX_VERTICES];
+                double sum = 0.0;
+                for (size_t q = 0; q < queries; ++q){
+                    for (size_t i = 0; i < figures.size(); ++i){
+                        sum += figures[i]->calculateArea();
+                        sum += static_cast<double>(vertices[figures[i]->writeVertices(vertices) - 1].x());
+                    }
+                }
+                doNotOptimize(sum);
+            }, 3));
+        };
+        Array<std::shared_ptr<Figure<Scalar>>> plain, cached;
+        for (size_t i = 0; i < n; ++i){
+            Scalar size = static_cast<Scalar>(1 + i % 97);
+            plain.push_back(std::make_shared<Shape>(size, Scalar(0), Scalar(0)));
+            cached.push_back(std::make_shared<CachedFigure<Shape>>(size, Scalar(0), Scalar(0)));
+        }
+        run(plain_variant, plain);
+        run(cached_variant, cached);
+    }
+}
+
+BENCHMARK(cached_figure){
+    benchmarkCachedFigure<double, Hexagon<double>>("hexagon_double_plain", "hexagon_double_cached");
+    benchmarkCachedFigure<int, Hexagon<int>>("hexagon_int_plain", "hexagon_int_cached");
+}
+
+// One frame: move and scale the whole scene.
+BENCHMARK(scene_transform){
+    const size_t n = std::min<size_t>(1000000, benchmarkMaxSize());
+    auto store = makeStore(n);
+    auto figures = toFigures(store);
+    reportResult("scene_transform", "virtual_per_figure", n, measureSeconds([&]{
+        translateFigures(figures, 0.5, -0.25);
+        scaleFigures(figures, 1.001, 0.0, 0.0);
+        doNotOptimize(figures.begin());
+    }));
+    reportResult("scene_transform", "columnar_store", n, measureSeconds([&]{
+        store.translate(0.5, -0.25);
+        store.scale(1.001, 0.0, 0.0);
+        doNotOptimize(store.rhombuses().x.begin());
+    }));
+}
+
+BENCHMARK(overlapping_pairs){
+    for (size_t n = 1000; n <= std::min<size_t>(1000000, benchmarkMaxSize()); n *= 10){
+        auto figures = makeScene(n);
+        reportResult("overlapping_pairs", "grid_1_thread", n, measureSeconds([&]{
+            doNotOptimize(findOverlappingPairs(figures, 1).size());
+        }, 3));
+        reportResult("overlapping_pairs", "grid_parallel", n, measureSeconds([&]{
+            doNotOptimize(findOverlappingPairs(figures).size());
+        }, 3));
+        if (n <= 10000){
+            // The old way: every pair, vertices fetched through getVertices().
+            reportResult("overlapping_pairs", "all_pairs_get_vertices", n, measureSeconds([&]{
+                size_t count = 0;
+                for (size_t i = 0; i < n; ++i){
+                    auto a = figures[i]->getVertices();
+                    for (size_t j = i + 1; j < n; ++j){
+                        auto b = figures[j]->getVertices();
+                        std::vector<Point<double>> pa, pb;
+                        for (const auto &v : a) pa.push_back(*v);
+                        for (const auto &v : b) pb.push_back(*v);
+                        count += convexPolygonsOverlap(pa.data(), pa.size(), pb.data(), pb.size());
+                    }
+                }
+                doNotOptimize(count);
+            }, 1));
+        }
+    }
+}
@@ -0,0 +1,189 @@
+#include "Benchmark.h"
+#include "FigureFile.h"
+#include "FigureUtils.h"
+#include "FigureParser.h"
+#include "FigureExporter.h"
+#include "FigurePipeline.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace {
+
+Array<std::shared_ptr<Figure<double>>> makeIoFigures(size_t n){
+    Array<std::shared_ptr<Figure<double>>> figures;
+    figures.reserve(n);
+    for (size_t i = 0; i < n; ++i){
+        double size = 1.0 + static_cast<double>(i % 97) * 0.25;
+        double x = static_cast<double>(i % 1000) * 0.5, y = static_cast<double>(i / 1000) * 0.5;
+        switch (i % 3){
+            case 0: figures.push_back(std::make_shared<Rhombus<double>>(size, size + 1.0, x, y)); break;
+            case 1: figures.push_back(std::make_shared<Pentagon<double>>(size, x, y)); break;
+            default: figures.push_back(std::make_shared<Hexagon<double>>(size, x, y)); break;
+        }
+    }
+    return figures;
+}
+
+std::string makeFigureText(size_t n){
+    std::ostringstream os;
+    for (size_t i = 0; i < n; ++i){
+        double size = 1.0 + static_cast<double>(i % 97) * 0.25;
+        double x = static_cast<double>(i % 1000) * 0.5, y = static_cast<double>(i / 1000) * 0.5;
+        switch (i % 3){
+            case 0: os << "R " << size << ' ' << size + 1.0 << ' ' << x << ' ' << y << '\n'; break;
+            case 1: os << "P " << size << ' ' << x << ' ' << y << '\n'; break;
+            default: os << "H " << size << ' ' << x << ' ' << y << '\n'; break;
+        }
+    }
+    return os.str();
+}
+
+// The interactive read() prompts on std::cout; keep that out of the output.
+class SilenceStdout{
+private:
+    std::ostringstream sink_;
+    std::streambuf *saved_;
+
+public:
+    SilenceStdout() : saved_(std::cout.rdbuf(sink_.rdbuf())){}
+    ~SilenceStdout(){
+        std::cout.rdbuf(saved_);
+    }
+};
+
+std::string benchmarkPath(const char *name){
+    return std::string("/tmp/labs_benchmark_") + name;
+}
+
+}
+
+BENCHMARK(figure_file){
+    const size_t n = std::min<size_t>(1000000, benchmarkMaxSize());
+    auto figures = makeIoFigures(n);
+    std::string path = benchmarkPath("figures.figb");
+    reportResult("figure_file", "write", n, measureSeconds([&]{
+        writeFigureFile(path, figures);
+    }, 3));
+    reportResult("figure_file", "map_and_total_area", n, measureSeconds([&]{
+        MappedFigureFile<double> file(path);
+        doNotOptimize(file.totalArea());
+    }));
+    reportResult("figure_file", "map_and_build_array", n, measureSeconds([&]{
+        MappedFigureFile<double> file(path);
+        doNotOptimize(file.toArray().size());
+    }, 3));
+    std::remove(path.c_str());
+}
+
+BENCHMARK(figure_text_parse){
+    const size_t n = std::min<size_t>(1000000, benchmarkMaxSize());
+    std::string text = makeFigureText(n);
+    reportResult("figure_text_parse", "from_chars_bulk", n, measureSeconds([&]{
+        doNotOptimize(parseFigures<double>(text).size());
+    }, 3));
+    reportResult("figure_text_parse", "from_chars_store", n, measureSeconds([&]{
+        doNotOptimize(parseFigureStore<double>(text).size());
+    }, 3));
+    reportResult("figure_text_parse", "operator_extract", n, measureSeconds([&]{
+        SilenceStdout silence;
+        std::istringstream is(text);
+        Array<std::shared_ptr<Figure<double>>> figures;
+        char tag;
+        while (is >> tag){
+            std::shared_ptr<Figure<double>> figure;
+            switch (tag){
+                case 'R': figure = std::make_shared<Rhombus<double>>(); break;
+                case 'P': figure = std::make_shared<Pentagon<double>>(); break;
+                default: figure = std::make_shared<Hexagon<double>>(); break;
+            }
+            is >> *figure;
+            figures.push_back(std::move(figure));
+        }
+        doNotOptimize(figures.size());
+    }, 3));
+}
+
+BENCHMARK(figure_export){
+    const size_t n = std::min<size_t>(1000000, benchmarkMaxSize());
+    auto figures = makeIoFigures(n);
+    std::string path = benchmarkPath("figures.txt");
+    reportResult("figure_export", "operator_insert", n, measureSeconds([&]{
+        std::ofstream os(path);
+        for (size_t i = 0; i < figures.size(); ++i){
+            os << *figures[i];
+        }
+    }, 3));
+    const std::pair<const char*, ExportFormat> formats[] = {
+        {"to_chars_text", ExportFormat::TEXT},
+        {"to_chars_csv", ExportFormat::CSV},
+        {"to_chars_json_lines", ExportFormat::JSON_LINES}
+    };
+    for (const auto &[variant, format] : formats){
+        reportResult("figure_export", variant, n, measureSeconds([&]{
+            std::ofstream os(path);
+            exportFigures(os, figures, format);
+        }, 3));
+    }
+    std::remove(path.c_str());
+}
+
+// Per-shape operator<< / operator>> round trip through in-memory streams.
+template<typename Shape>
+void benchmarkStreamIo(const char *shape, const Shape &figure, const char *line, size_t n){
+    std::ostringstream text;
+    reportResult(std::string("stream_io_") + shape, "operator_insert", n, measureSeconds([&]{
+        text.str("");
+        for (size_t i = 0; i < n; ++i){
+            text << figure;
+        }
+    }, 3));
+    std::string params;
+    for (size_t i = 0; i < n; ++i){
+        params += line;
+    }
+    reportResult(std::string("stream_io_") + shape, "operator_extract", n, measureSeconds([&]{
+        SilenceStdout silence;
+        std::istringstream is(params);
+        Shape target;
+        for (size_t i = 0; i < n; ++i){
+            is >> target;
+        }
+        doNotOptimize(target.calculateArea());
+    }, 3));
+}
+
+BENCHMARK(stream_io){
+    const size_t n = std::min<size_t>(100000, benchmarkMaxSize());
+    benchmarkStreamIo("rhombus", Rhombus<double>(3.0, 4.0, 1.0, 2.0), "3 4 1 2\n", n);
+    benchmarkStreamIo("pentagon", Pentagon<double>(3.0, 1.0, 2.0), "3 1 2\n", n);
+    benchmarkStreamIo("hexagon", Hexagon<double>(3.0, 1.0, 2.0), "3 1 2\n", n);
+}
+
+BENCHMARK(stream_pipeline){
+    for (size_t n = 1000; n <= std::min<size_t>(1000000, benchmarkMaxSize()); n *= 10){
+        std::string text = makeFigureText(n);
+        // The previous way: load everything, then one pass per result.
+        reportResult("stream_pipeline", "three_passes", n, measureSeconds([&]{
+            std::istringstream is(text);
+            auto figures = parseFigures<double>(is);
+            double area = calculateTotalArea(figures);
+            BoundingBox bounds;
+            size_t vertices = 0;
+            for (const auto &figure : figures){
+                FigureMetrics metrics = computeFigureMetrics(*figure);
+                bounds.expand(metrics.bounds);
+                vertices += metrics.vertexCount;
+            }
+            doNotOptimize(area + bounds.maxX + static_cast<double>(vertices));
+        }, 3));
+        reportResult("stream_pipeline", "pipeline", n, measureSeconds([&]{
+            std::istringstream is(text);
+            FigureStreamTotals totals = streamFigureTotals<double>(is);
+            doNotOptimize(totals.totalArea + totals.bounds.maxX + static_cast<double>(totals.vertices));
+        }, 3));
+    }
+}
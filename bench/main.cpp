@@ -0,0 +1,19 @@
+#include "Benchmark.h"
+#include <cstdlib>
+#include <cstring>
+
+// Usage: benchmarks [filter [max_n]] - runs every benchmark whose name
+// contains filter, with inputs of at most max_n items.
+int main(int argc, char **argv){
+    const char *filter = argc > 1 ? argv[1] : "";
+    if (argc > 2){
+        benchmarkMaxSize() = std::strtoull(argv[2], nullptr, 10);
+    }
+    std::cout << "benchmark,variant,n,seconds,ns_per_item" << std::endl;
+    for (const auto &benchmark : benchmarkRegistry()){
+        if (std::strstr(benchmark.name, filter)){
+            benchmark.function();
+        }
+    }
+    return 0;
+}
@@ -2,65 +2,283 @@
 #define ARRAY_H
 
 #include <utility>
+#include <algorithm>
 #include <memory>
+#include <memory_resource>
 #include <stdexcept>
 #include <initializer_list>
+#include <cstring>
+#include "Relocation.h"
+#ifdef ARRAY_STATS
+#include "ArrayStats.h"
+#endif
 
-template<typename T>
+// Storage is raw memory obtained from Alloc; only [0, size_) holds live
+// objects, the rest of the capacity stays uninitialized.
+template<typename T, typename Alloc = std::allocator<T>>
 class Array {
 private:
-    std::shared_ptr<T[]> data_;
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    T *data_;
     size_t size_;
     size_t capacity_;
+    [[no_unique_address]] Alloc alloc_;
+#ifdef ARRAY_STATS
+    ArrayStats stats_;
+#endif
+
+    // Instrumentation hooks; they compile to nothing without ARRAY_STATS.
+    void countAllocation([[maybe_unused]] size_t n){
+#ifdef ARRAY_STATS
+        size_t bytes = n * sizeof(T);
+        ++stats_.allocations;
+        stats_.allocatedBytes += bytes;
+        stats_.peakBytes = std::max(stats_.peakBytes, bytes);
+        globalArrayStats().addAllocation(bytes);
+#endif
+    }
+    void countReallocation(){
+#ifdef ARRAY_STATS
+        if (capacity_ > 0){
+            ++stats_.reallocations;
+            globalArrayStats().addReallocation();
+        }
+#endif
+    }
+    void countMoves([[maybe_unused]] size_t count){
+#ifdef ARRAY_STATS
+        stats_.elementMoves += count;
+        globalArrayStats().addMoves(count);
+#endif
+    }
+    void countCopies([[maybe_unused]] size_t count){
+#ifdef ARRAY_STATS
+        stats_.elementCopies += count;
+        globalArrayStats().addCopies(count);
+#endif
+    }
+    // Work done on a temporary whose storage this array has taken over.
+    void adoptStats([[maybe_unused]] const Array &from){
+#ifdef ARRAY_STATS
+        stats_.allocations += from.stats_.allocations;
+        stats_.allocatedBytes += from.stats_.allocatedBytes;
+        stats_.reallocations += from.stats_.reallocations;
+        stats_.elementMoves += from.stats_.elementMoves;
+        stats_.elementCopies += from.stats_.elementCopies;
+        stats_.peakBytes = std::max(stats_.peakBytes, from.stats_.peakBytes);
+#endif
+    }
+    // Counters follow the storage when it is moved out of from.
+    void takeStats([[maybe_unused]] Array &from){
+#ifdef ARRAY_STATS
+        adoptStats(from);
+        from.stats_ = ArrayStats();
+#endif
+    }
+
+    T *allocate(size_t n){
+        if (n == 0){
+            return nullptr;
+        }
+        T *data = AllocTraits::allocate(alloc_, n);
+        countAllocation(n);
+        return data;
+    }
+    void deallocate(T *data, size_t n){
+        if (data){
+            AllocTraits::deallocate(alloc_, data, n);
+        }
+    }
+    void destroy(T *first, T *last){
+        for (; first != last; ++first){
+            AllocTraits::destroy(alloc_, first);
+        }
+    }
+    // Frees the current buffer; its elements must already be destroyed.
+    void freeStorage(){
+#ifdef ARRAY_STATS
+        globalArrayStats().addWaste((capacity_ - size_) * sizeof(T));
+#endif
+        deallocate(data_, capacity_);
+    }
+    void release(){
+        destroy(data_, data_ + size_);
+        freeStorage();
+        data_ = nullptr;
+        size_ = 0;
+        capacity_ = 0;
+    }
+    // Constructs [0, count) of dest from src, rolling back on exception.
+    template<typename Source>
+    void constructFrom(T *dest, Source src, size_t count){
+        size_t i = 0;
+        try{
+            for (; i < count; ++i, ++src){
+                AllocTraits::construct(alloc_, dest + i, *src);
+            }
+        } catch (...){
+            destroy(dest, dest + i);
+            throw;
+        }
+    }
+    // Bulk byte copies for trivially relocatable / copyable element types.
+    static void moveBytes(T *dest, const T *src, size_t count){
+        if (count > 0){
+            std::memmove(static_cast<void*>(dest), static_cast<const void*>(src), count * sizeof(T));
+        }
+    }
+    void relocate(T *new_data){
+        if constexpr (is_trivially_relocatable_v<T>){
+            moveBytes(new_data, data_, size_);
+            countMoves(size_);
+            return;
+        } else if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>){
+            constructFrom(new_data, std::make_move_iterator(data_), size_);
+            countMoves(size_);
+        } else {
+            constructFrom(new_data, static_cast<const T*>(data_), size_);
+            countCopies(size_);
+        }
+        destroy(data_, data_ + size_);
+    }
     void reallocate(size_t new_capacity){
-        std::shared_ptr<T[]> new_data(new T[new_capacity]);
-        for(size_t i = 0; i < size_; ++i){
-            new_data[i] = std::move(data_[i]);
+        T *new_data = allocate(new_capacity);
+        try{
+            relocate(new_data);
+        } catch (...){
+            deallocate(new_data, new_capacity);
+            throw;
         }
-        data_ = std::move(new_data);
+        countReallocation();
+        freeStorage();
+        data_ = new_data;
         capacity_ = new_capacity;
     }
-public:
-    Array() : size_(0), capacity_(0){}
-    explicit Array(size_t size) : size_(size), capacity_(size){
-        if (size > 0){
-            data_ = std::shared_ptr<T[]>(new T[capacity_]);
-        }
+    size_t grownCapacity() const{
+        return capacity_ == 0 ? 1 : capacity_ * 2;
     }
-    Array(std::initializer_list<T> init) : size_(init.size()), capacity_(init.size()){
-        if (size_ > 0){
-            data_ = std::shared_ptr<T[]>(new T[capacity_]);
-            size_t i = 0;
-            for (const auto &item : init){
-                data_[i++] = item;
+    void swapStorage(Array &other) noexcept{
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+    void copyFrom(const Array &other){
+        data_ = allocate(other.capacity_);
+        try{
+            if constexpr (std::is_trivially_copyable_v<T>){
+                moveBytes(data_, other.data_, other.size_);
+            } else {
+                constructFrom(data_, static_cast<const T*>(other.data_), other.size_);
             }
+        } catch (...){
+            deallocate(data_, other.capacity_);
+            data_ = nullptr;
+            throw;
         }
+        countCopies(other.size_);
+        size_ = other.size_;
+        capacity_ = other.capacity_;
     }
-    Array(const Array &other) : size_(other.size_), capacity_(other.capacity_){
-        if (size_ > 0){
-            data_ = std::shared_ptr<T[]>(new T[capacity_]);
-            for (size_t i = 0; i < size_; ++i){
-                data_[i] = other.data_[i];
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+
+    Array() : Array(Alloc()){}
+    explicit Array(const Alloc &alloc) : data_(nullptr), size_(0), capacity_(0), alloc_(alloc){}
+    explicit Array(size_t size, const Alloc &alloc = Alloc()) : Array(alloc){
+        data_ = allocate(size);
+        size_t i = 0;
+        try{
+            for (; i < size; ++i){
+                AllocTraits::construct(alloc_, data_ + i);
             }
+        } catch (...){
+            destroy(data_, data_ + i);
+            deallocate(data_, size);
+            throw;
+        }
+        size_ = size;
+        capacity_ = size;
+    }
+    Array(std::initializer_list<T> init, const Alloc &alloc = Alloc()) : Array(alloc){
+        data_ = allocate(init.size());
+        try{
+            constructFrom(data_, init.begin(), init.size());
+        } catch (...){
+            deallocate(data_, init.size());
+            throw;
         }
+        countCopies(init.size());
+        size_ = init.size();
+        capacity_ = init.size();
+    }
+    Array(const Array &other) : Array(AllocTraits::select_on_container_copy_construction(other.alloc_)){
+        copyFrom(other);
+    }
+    Array(const Array &other, const Alloc &alloc) : Array(alloc){
+        copyFrom(other);
     }
-    Array(Array &&other) noexcept : data_(std::move(other.data_)), size_(other.size_), capacity_(other.capacity_){
+    Array(Array &&other) noexcept : data_(other.data_), size_(other.size_), capacity_(other.capacity_), alloc_(std::move(other.alloc_)){
+#ifdef ARRAY_STATS
+        stats_ = other.stats_;
+        other.stats_ = ArrayStats();
+#endif
+        other.data_ = nullptr;
         other.size_ = 0;
         other.capacity_ = 0;
     }
-    ~Array() = default;
+    ~Array(){
+        release();
+    }
     Array &operator=(const Array &other){
         if (this != &other){
-            std::shared_ptr<T[]> new_data;
-            if (other.size_ > 0){
-                new_data = std::shared_ptr<T[]>(new T[other.capacity_]);
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value){
+                if (alloc_ != other.alloc_){
+                    release();
+                }
+                alloc_ = other.alloc_;
+            }
+            // Plain data is copied into the current buffer when it fits.
+            if constexpr (std::is_trivially_copyable_v<T>){
+                if (capacity_ >= other.size_){
+                    moveBytes(data_, other.data_, other.size_);
+                    countCopies(other.size_);
+                    size_ = other.size_;
+                    return *this;
+                }
+            }
+            Array copy(other, alloc_);
+            swapStorage(copy);
+            adoptStats(copy);
+        }
+        return *this;
+    }
+    Array &operator=(Array &&other) noexcept(AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value){
+        if (this == &other){
+            return *this;
+        }
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value){
+            release();
+            alloc_ = std::move(other.alloc_);
+            swapStorage(other);
+            takeStats(other);
+        } else {
+            if (alloc_ == other.alloc_){
+                release();
+                swapStorage(other);
+                takeStats(other);
+            } else {
+                Array moved(alloc_);
+                moved.reserve(other.size_);
                 for (size_t i = 0; i < other.size_; ++i){
-                    new_data[i] = other.data_[i];
+                    moved.emplace_back(std::move(other.data_[i]));
                 }
+                swapStorage(moved);
+                adoptStats(moved);
+                other.clear();
             }
-            data_ = std::move(new_data);
-            size_ = other.size_;
-            capacity_ = other.capacity_;
         }
         return *this;
     }
@@ -76,37 +294,172 @@ public:
         }
         return data_[index];
     }
-    void push_back(const T &value){
-        if (size_ >=capacity_){
-            reallocate(capacity_ == 0 ? 1 : capacity_ * 2);
+    template<typename... Args>
+    T &emplace_back(Args &&...args){
+        if (size_ < capacity_){
+            AllocTraits::construct(alloc_, data_ + size_, std::forward<Args>(args)...);
+            return data_[size_++];
+        }
+        // The new element is built before the old ones move, so args may
+        // still refer into the current buffer.
+        size_t new_capacity = grownCapacity();
+        T *new_data = allocate(new_capacity);
+        try{
+            AllocTraits::construct(alloc_, new_data + size_, std::forward<Args>(args)...);
+        } catch (...){
+            deallocate(new_data, new_capacity);
+            throw;
+        }
+        try{
+            relocate(new_data);
+        } catch (...){
+            AllocTraits::destroy(alloc_, new_data + size_);
+            deallocate(new_data, new_capacity);
+            throw;
         }
-        data_[size_++] = value;
+        countReallocation();
+        freeStorage();
+        data_ = new_data;
+        capacity_ = new_capacity;
+        return data_[size_++];
+    }
+    void push_back(const T &value){
+        emplace_back(value);
     }
     void push_back(T &&value){
-        if (size_ >= capacity_){
-            reallocate(capacity_ == 0 ? 1 : capacity_ * 2);
+        emplace_back(std::move(value));
+    }
+    void reserve(size_t new_capacity){
+        if (new_capacity > capacity_){
+            reallocate(new_capacity);
+        }
+    }
+    void shrink_to_fit(){
+        if (size_ == 0){
+            release();
+        } else if (size_ < capacity_){
+            reallocate(size_);
         }
-        data_[size_++] = std::move(value);
     }
     void remove(size_t index){
         if (index >= size_){
             throw std::out_of_range("Array index out of bounds");
         }
-        for (size_t i = index; i < size_ - 1; ++i){
-            data_[i] = std::move(data_[i + 1]);
+        if constexpr (is_trivially_relocatable_v<T>){
+            AllocTraits::destroy(alloc_, data_ + index);
+            moveBytes(data_ + index, data_ + index + 1, size_ - 1 - index);
+        } else {
+            for (size_t i = index; i < size_ - 1; ++i){
+                data_[i] = std::move(data_[i + 1]);
+            }
+            AllocTraits::destroy(alloc_, data_ + size_ - 1);
+        }
+        countMoves(size_ - 1 - index);
+        --size_;
+    }
+    // O(1): the last element takes the removed slot, order is not kept.
+    void swap_remove(size_t index){
+        if (index >= size_){
+            throw std::out_of_range("Array index out of bounds");
+        }
+        if constexpr (is_trivially_relocatable_v<T>){
+            AllocTraits::destroy(alloc_, data_ + index);
+            if (index != size_ - 1){
+                moveBytes(data_ + index, data_ + size_ - 1, 1);
+                countMoves(1);
+            }
+        } else {
+            if (index != size_ - 1){
+                data_[index] = std::move(data_[size_ - 1]);
+                countMoves(1);
+            }
+            AllocTraits::destroy(alloc_, data_ + size_ - 1);
         }
         --size_;
     }
+    // Removes [first, last) with a single shift of the tail.
+    void erase(size_t first, size_t last){
+        if (first > last || last > size_){
+            throw std::out_of_range("Array erase range out of bounds");
+        }
+        if constexpr (is_trivially_relocatable_v<T>){
+            destroy(data_ + first, data_ + last);
+            moveBytes(data_ + first, data_ + last, first == last ? 0 : size_ - last);
+        } else {
+            T *new_end = std::move(data_ + last, data_ + size_, data_ + first);
+            destroy(new_end, data_ + size_);
+        }
+        countMoves(first == last ? 0 : size_ - last);
+        size_ -= last - first;
+    }
+    // Single compacting pass; keeps the order of the remaining elements.
+    template<typename Predicate>
+    size_t erase_if(Predicate pred){
+        size_t kept = 0;
+        if constexpr (is_trivially_relocatable_v<T>){
+            size_t i = 0;
+            try{
+                for (; i < size_; ++i){
+                    if (pred(std::as_const(data_[i]))){
+                        AllocTraits::destroy(alloc_, data_ + i);
+                    } else {
+                        if (kept != i){
+                            moveBytes(data_ + kept, data_ + i, 1);
+                            countMoves(1);
+                        }
+                        ++kept;
+                    }
+                }
+            } catch (...){
+                // Close the gap so the array stays contiguous.
+                moveBytes(data_ + kept, data_ + i, size_ - i);
+                size_ = kept + (size_ - i);
+                throw;
+            }
+            size_t removed = size_ - kept;
+            size_ = kept;
+            return removed;
+        }
+        for (size_t i = 0; i < size_; ++i){
+            if (!pred(std::as_const(data_[i]))){
+                if (kept != i){
+                    data_[kept] = std::move(data_[i]);
+                    countMoves(1);
+                }
+                ++kept;
+            }
+        }
+        size_t removed = size_ - kept;
+        destroy(data_ + kept, data_ + size_);
+        size_ = kept;
+        return removed;
+    }
     void clear(){
+        destroy(data_, data_ + size_);
         size_ = 0;
     }
     size_t size() const {return size_;}
     size_t capacity() const {return capacity_;}
     bool empty() const {return size_ == 0;}
-    T* begin() {return data_.get();}
-    const T* begin() const{return data_.get();}
-    T* end() {return data_.get() + size_;}
-    const T* end() const{return data_.get() + size_;}
+    Alloc get_allocator() const {return alloc_;}
+#ifdef ARRAY_STATS
+    // Counters for this instance; wastedBytes is the unused capacity now.
+    ArrayStats stats() const{
+        ArrayStats stats = stats_;
+        stats.wastedBytes = (capacity_ - size_) * sizeof(T);
+        return stats;
+    }
+    void resetStats(){
+        stats_ = ArrayStats();
+    }
+#endif
+    T* begin() {return data_;}
+    const T* begin() const{return data_;}
+    T* end() {return data_ + size_;}
+    const T* end() const{return data_ + size_;}
 };
 
-#endif
\ No newline at end of file
+template<typename T>
+using PmrArray = Array<T, std::pmr::polymorphic_allocator<T>>;
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef ARRAYSTATS_H
+#define ARRAYSTATS_H
+
+#include <atomic>
+#include <cstddef>
+
+// Counters kept by Array when built with ARRAY_STATS defined (CMake option
+// LABS_ARRAY_STATS). Without it Array carries no counters and no code.
+//
+// elementMoves counts moves done by the container itself (growth and
+// shifting on removal); elementCopies counts copy constructions (copying a
+// whole Array, or growth for types that cannot be moved without throwing).
+// wastedBytes is the unused capacity: the current one in Array::stats(), and
+// the total left in every buffer at the moment it was freed in the global
+// totals.
+struct ArrayStats{
+    size_t allocations = 0;
+    size_t allocatedBytes = 0;
+    size_t reallocations = 0;
+    size_t elementMoves = 0;
+    size_t elementCopies = 0;
+    size_t peakBytes = 0;
+    size_t wastedBytes = 0;
+};
+
+class GlobalArrayStats{
+private:
+    std::atomic<size_t> allocations_{0};
+    std::atomic<size_t> allocatedBytes_{0};
+    std::atomic<size_t> reallocations_{0};
+    std::atomic<size_t> elementMoves_{0};
+    std::atomic<size_t> elementCopies_{0};
+    std::atomic<size_t> peakBytes_{0};
+    std::atomic<size_t> wastedBytes_{0};
+
+public:
+    void addAllocation(size_t bytes){
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+        size_t peak = peakBytes_.load(std::memory_order_relaxed);
+        while (bytes > peak && !peakBytes_.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)){
+        }
+    }
+    void addReallocation(){
+        reallocations_.fetch_add(1, std::memory_order_relaxed);
+    }
+    void addMoves(size_t count){
+        elementMoves_.fetch_add(count, std::memory_order_relaxed);
+    }
+    void addCopies(size_t count){
+        elementCopies_.fetch_add(count, std::memory_order_relaxed);
+    }
+    void addWaste(size_t bytes){
+        wastedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    // peakBytes is the largest single buffer any Array has allocated.
+    ArrayStats snapshot() const{
+        ArrayStats stats;
+        stats.allocations = allocations_.load(std::memory_order_relaxed);
+        stats.allocatedBytes = allocatedBytes_.load(std::memory_order_relaxed);
+        stats.reallocations = reallocations_.load(std::memory_order_relaxed);
+        stats.elementMoves = elementMoves_.load(std::memory_order_relaxed);
+        stats.elementCopies = elementCopies_.load(std::memory_order_relaxed);
+        stats.peakBytes = peakBytes_.load(std::memory_order_relaxed);
+        stats.wastedBytes = wastedBytes_.load(std::memory_order_relaxed);
+        return stats;
+    }
+    void reset(){
+        allocations_.store(0, std::memory_order_relaxed);
+        allocatedBytes_.store(0, std::memory_order_relaxed);
+        reallocations_.store(0, std::memory_order_relaxed);
+        elementMoves_.store(0, std::memory_order_relaxed);
+        elementCopies_.store(0, std::memory_order_relaxed);
+        peakBytes_.store(0, std::memory_order_relaxed);
+        wastedBytes_.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Totals over every Array instantiation in the program.
+inline GlobalArrayStats &globalArrayStats(){
+    static GlobalArrayStats stats;
+    return stats;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef BOUNDINGBOX_H
+#define BOUNDINGBOX_H
+
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+
+// Axis-aligned box in double coordinates (like calculateArea, independent
+// of the figure's scalar type).
+struct BoundingBox{
+    double minX = std::numeric_limits<double>::infinity();
+    double minY = std::numeric_limits<double>::infinity();
+    double maxX = -std::numeric_limits<double>::infinity();
+    double maxY = -std::numeric_limits<double>::infinity();
+
+    bool empty() const{
+        return minX > maxX || minY > maxY;
+    }
+    bool intersects(const BoundingBox &other) const{
+        return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+    }
+    bool contains(double x, double y) const{
+        return minX <= x && x <= maxX && minY <= y && y <= maxY;
+    }
+    void expand(double x, double y){
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+    }
+    void expand(const BoundingBox &other){
+        minX = std::min(minX, other.minX);
+        minY = std::min(minY, other.minY);
+        maxX = std::max(maxX, other.maxX);
+        maxY = std::max(maxY, other.maxY);
+    }
+    bool operator==(const BoundingBox &other) const = default;
+};
+
+// Batch kernels write boxes as flat records of minX, minY, maxX, maxY.
+constexpr size_t BOUNDING_BOX_STRIDE = 4;
+
+#endif
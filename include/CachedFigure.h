@@ -0,0 +1,121 @@
+#ifndef CACHEDFIGURE_H
+#define CACHEDFIGURE_H
+
+#include "Figure.h"
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include <utility>
+
+// Shape that computes its area and vertices on first use and keeps them
+// until it is modified. Plain shapes stay as they are; caching is opted
+// into by using CachedFigure<Hexagon<int>> in place of Hexagon<int>.
+// Every mutation path of the shape (read, transforms, assignment, moves)
+// goes through this class and drops the cache. The cache is filled from
+// const calls, so the first use of one object must not race between threads.
+//
+// When to use it: integer or float shapes whose vertices are read many times
+// between changes. Their vertices are computed in double and converted back
+// on every query; the cache cuts query time by a quarter to a third
+// (cached_figure benchmark, Hexagon<int>). For double shapes the computation
+// costs as much as the copy out of the cache, and the larger object costs
+// more at scale. Use plain shapes there.
+template<typename Shape>
+class CachedFigure : public Shape{
+private:
+    using Scalar = std::remove_cvref_t<decltype(std::declval<const Shape&>().calculateCenter().x())>;
+
+    mutable std::array<Point<Scalar>, Shape::VERTEX_COUNT> vertices_;
+    mutable double area_ = 0.0;
+    mutable bool valid_ = false;
+
+    void fill() const{
+        if (!valid_){
+            area_ = Shape::calculateArea();
+            Shape::writeVertices(vertices_.data());
+            valid_ = true;
+        }
+    }
+
+public:
+    using Shape::Shape;
+    CachedFigure() = default;
+    explicit CachedFigure(const Shape &shape) : Shape(shape){}
+    CachedFigure(const CachedFigure &other) : Shape(other), vertices_(other.vertices_), area_(other.area_), valid_(other.valid_){}
+    CachedFigure(CachedFigure &&other) noexcept : Shape(std::move(static_cast<Shape&>(other))){
+        other.invalidate();
+    }
+    CachedFigure &operator=(const CachedFigure &other){
+        if (this != &other){
+            Shape::operator=(other);
+            vertices_ = other.vertices_;
+            area_ = other.area_;
+            valid_ = other.valid_;
+        }
+        return *this;
+    }
+    CachedFigure &operator=(CachedFigure &&other) noexcept{
+        if (this != &other){
+            Shape::operator=(std::move(static_cast<Shape&>(other)));
+            invalidate();
+            other.invalidate();
+        }
+        return *this;
+    }
+    CachedFigure &operator=(const Shape &shape){
+        Shape::operator=(shape);
+        invalidate();
+        return *this;
+    }
+
+    void invalidate() const{
+        valid_ = false;
+    }
+    bool isCached() const {return valid_;}
+
+    double calculateArea() const override{
+        fill();
+        return area_;
+    }
+    const std::array<Point<Scalar>, Shape::VERTEX_COUNT> &vertices() const{
+        fill();
+        return vertices_;
+    }
+    size_t writeVertices(Point<Scalar> *out) const override{
+        fill();
+        std::copy(vertices_.begin(), vertices_.end(), out);
+        return Shape::VERTEX_COUNT;
+    }
+    std::vector<PointPtr<Scalar>> getVertices() const override{
+        std::vector<PointPtr<Scalar>> result;
+        result.reserve(Shape::VERTEX_COUNT);
+        for (const auto &vertex : vertices()){
+            result.push_back(std::make_unique<Point<Scalar>>(vertex));
+        }
+        return result;
+    }
+    void printVertices(std::ostream &os) const override{
+        os << this->label() << "\n";
+        for (const auto &vertex : vertices()){
+            os << vertex << "\n";
+        }
+    }
+    void translate(Scalar dx, Scalar dy) override{
+        invalidate();
+        Shape::translate(dx, dy);
+    }
+    void scale(Scalar factor, Scalar pivot_x, Scalar pivot_y) override{
+        invalidate();
+        Shape::scale(factor, pivot_x, pivot_y);
+    }
+    bool rotateQuarterTurns(int quarters, Scalar pivot_x, Scalar pivot_y) override{
+        invalidate();
+        return Shape::rotateQuarterTurns(quarters, pivot_x, pivot_y);
+    }
+    void read(std::istream &is) override{
+        invalidate();
+        Shape::read(is);
+    }
+};
+
+#endif
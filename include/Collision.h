@@ -0,0 +1,241 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "Figure.h"
+#include "Array.h"
+#include "BoundingBox.h"
+#include "FigureUtils.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Separating-axis test for two convex polygons given by their vertices in
+// order. Shapes that only touch count as overlapping, like BoundingBox.
+// Besides the edge normals, the x and y axes are always tried, and a
+// polygon collapsed to a segment also tries its own direction, so points,
+// segments and repeated vertices are handled too.
+template<ScalarType T>
+bool convexPolygonsOverlap(const Point<T> *a, size_t a_count, const Point<T> *b, size_t b_count){
+    auto separatedAlong = [a, a_count, b, b_count](double axis_x, double axis_y){
+        auto project = [axis_x, axis_y](const Point<T> *points, size_t count, double &low, double &high){
+            low = high = axis_x * static_cast<double>(points[0].x()) + axis_y * static_cast<double>(points[0].y());
+            for (size_t k = 1; k < count; ++k){
+                double value = axis_x * static_cast<double>(points[k].x()) + axis_y * static_cast<double>(points[k].y());
+                low = std::min(low, value);
+                high = std::max(high, value);
+            }
+        };
+        double a_low, a_high, b_low, b_high;
+        project(a, a_count, a_low, a_high);
+        project(b, b_count, b_low, b_high);
+        return a_high < b_low || b_high < a_low;
+    };
+    auto separatedAlongEdgesOf = [&separatedAlong](const Point<T> *edges, size_t edge_count){
+        double twice_area = 0.0;
+        for (size_t i = 0; i < edge_count; ++i){
+            const Point<T> &from = edges[i];
+            const Point<T> &to = edges[i + 1 == edge_count ? 0 : i + 1];
+            twice_area += static_cast<double>(from.x()) * static_cast<double>(to.y())
+                        - static_cast<double>(to.x()) * static_cast<double>(from.y());
+        }
+        for (size_t i = 0; i < edge_count; ++i){
+            const Point<T> &from = edges[i];
+            const Point<T> &to = edges[i + 1 == edge_count ? 0 : i + 1];
+            double edge_x = static_cast<double>(to.x()) - static_cast<double>(from.x());
+            double edge_y = static_cast<double>(to.y()) - static_cast<double>(from.y());
+            if (edge_x == 0.0 && edge_y == 0.0){
+                continue;
+            }
+            if (separatedAlong(-edge_y, edge_x) || (twice_area == 0.0 && separatedAlong(edge_x, edge_y))){
+                return true;
+            }
+        }
+        return false;
+    };
+    if (a_count == 0 || b_count == 0){
+        return false;
+    }
+    return !separatedAlong(1.0, 0.0) && !separatedAlong(0.0, 1.0)
+        && !separatedAlongEdgesOf(a, a_count) && !separatedAlongEdgesOf(b, b_count);
+}
+
+// Exact overlap of two figures; vertices go to stack buffers.
+template<ScalarType T>
+bool figuresOverlap(const Figure<T> &a, const Figure<T> &b){
+    Point<T> a_vertices[Figure<T>::MAX_VERTICES];
+    Point<T> b_vertices[Figure<T>::MAX_VERTICES];
+    size_t a_count = a.writeVertices(a_vertices);
+    size_t b_count = b.writeVertices(b_vertices);
+    return convexPolygonsOverlap(a_vertices, a_count, b_vertices, b_count);
+}
+
+using OverlapPair = std::pair<size_t, size_t>;
+
+// Broad phase grid. Each box is entered into every cell it overlaps, and
+// entries are sorted by cell so each cell's figures are contiguous.
+// Figures covering more than GRID_LARGE_FIGURE_CELLS cells, or with
+// non-finite boxes, are tested directly against everything instead.
+constexpr size_t GRID_LARGE_FIGURE_CELLS = 64;
+
+struct GridEntry{
+    uint64_t cell;
+    size_t index;
+
+    bool operator<(const GridEntry &other) const{
+        return cell < other.cell || (cell == other.cell && index < other.index);
+    }
+};
+
+inline int64_t gridCoord(double value, double cell_size){
+    return static_cast<int64_t>(std::clamp(std::floor(value / cell_size), -2147483647.0, 2147483647.0));
+}
+
+inline uint64_t gridCellKey(int64_t x, int64_t y){
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+// All pairs (i, j), i < j, of overlapping figures, sorted. The broad phase
+// is the grid above; a pair sharing several cells is only tested in the
+// cell holding the lower corner of the boxes' overlap. The narrow phase is
+// the separating-axis test on stack vertex buffers. Both the cell runs and
+// the large figures are spread over threads; the result does not depend on
+// the thread count.
+template<ScalarType T, typename Alloc>
+Array<OverlapPair> findOverlappingPairs(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures, unsigned threads = defaultThreadCount()){
+    size_t n = figures.size();
+    const std::shared_ptr<Figure<T>> *data = figures.begin();
+    std::vector<BoundingBox> boxes(n);
+    size_t blocks = (n + AREA_BLOCK_SIZE - 1) / AREA_BLOCK_SIZE;
+    parallelFor(blocks, threads, [&](size_t begin, size_t end){
+        for (size_t i = begin * AREA_BLOCK_SIZE; i < std::min(end * AREA_BLOCK_SIZE, n); ++i){
+            boxes[i] = data[i]->boundingBox();
+        }
+    });
+
+    // Mean larger box side, as in SpatialGrid.
+    double side_sum = 0.0;
+    size_t finite = 0;
+    for (const BoundingBox &box : boxes){
+        double side = std::max(box.maxX - box.minX, box.maxY - box.minY);
+        if (std::isfinite(side) && std::isfinite(box.minX) && std::isfinite(box.minY)){
+            side_sum += side;
+            ++finite;
+        }
+    }
+    double cell_size = finite > 0 ? side_sum / static_cast<double>(finite) : 1.0;
+    if (!(cell_size > 0.0) || !std::isfinite(cell_size)){
+        cell_size = 1.0;
+    }
+
+    std::vector<GridEntry> entries;
+    entries.reserve(n * 2);
+    std::vector<size_t> large;
+    for (size_t i = 0; i < n; ++i){
+        const BoundingBox &box = boxes[i];
+        bool usable = std::isfinite(box.minX) && std::isfinite(box.minY) && std::isfinite(box.maxX) && std::isfinite(box.maxY);
+        int64_t x0 = 0, x1 = -1, y0 = 0, y1 = -1;
+        if (usable){
+            x0 = gridCoord(box.minX, cell_size);
+            x1 = gridCoord(box.maxX, cell_size);
+            y0 = gridCoord(box.minY, cell_size);
+            y1 = gridCoord(box.maxY, cell_size);
+        }
+        if (!usable || static_cast<double>(x1 - x0 + 1) * static_cast<double>(y1 - y0 + 1) > static_cast<double>(GRID_LARGE_FIGURE_CELLS)){
+            large.push_back(i);
+            continue;
+        }
+        for (int64_t x = x0; x <= x1; ++x){
+            for (int64_t y = y0; y <= y1; ++y){
+                entries.push_back({gridCellKey(x, y), i});
+            }
+        }
+    }
+    parallelSort(entries.data(), entries.size(), threads, std::less<GridEntry>());
+    std::vector<size_t> runs;
+    for (size_t e = 0; e < entries.size(); ++e){
+        if (e == 0 || entries[e].cell != entries[e - 1].cell){
+            runs.push_back(e);
+        }
+    }
+    runs.push_back(entries.size());
+    std::vector<bool> is_large(n);
+    for (size_t i : large){
+        is_large[i] = true;
+    }
+
+    auto narrowPhase = [data](size_t i, size_t j, Point<T> *vertices, Point<T> *other){
+        size_t count = data[i]->writeVertices(vertices);
+        size_t other_count = data[j]->writeVertices(other);
+        return convexPolygonsOverlap(vertices, count, other, other_count);
+    };
+    size_t run_count = runs.size() - 1;
+    size_t chunks = std::max<size_t>((run_count + AREA_BLOCK_SIZE - 1) / AREA_BLOCK_SIZE, std::max(threads, 1u));
+    std::vector<std::vector<OverlapPair>> found(chunks + large.size());
+    parallelFor(chunks, threads, [&](size_t begin, size_t end){
+        Point<T> vertices[Figure<T>::MAX_VERTICES];
+        Point<T> other[Figure<T>::MAX_VERTICES];
+        for (size_t chunk = begin; chunk < end; ++chunk){
+            std::vector<OverlapPair> &pairs = found[chunk];
+            for (size_t run = run_count * chunk / chunks; run < run_count * (chunk + 1) / chunks; ++run){
+                uint64_t cell = entries[runs[run]].cell;
+                int64_t cell_x = static_cast<int32_t>(cell >> 32);
+                int64_t cell_y = static_cast<int32_t>(cell & 0xffffffffu);
+                for (size_t a = runs[run]; a < runs[run + 1]; ++a){
+                    size_t i = entries[a].index;
+                    for (size_t b = a + 1; b < runs[run + 1]; ++b){
+                        size_t j = entries[b].index;
+                        if (!boxes[i].intersects(boxes[j])
+                            || gridCoord(std::max(boxes[i].minX, boxes[j].minX), cell_size) != cell_x
+                            || gridCoord(std::max(boxes[i].minY, boxes[j].minY), cell_size) != cell_y){
+                            continue;
+                        }
+                        if (narrowPhase(i, j, vertices, other)){
+                            pairs.emplace_back(i, j);
+                        }
+                    }
+                }
+            }
+        }
+    });
+    parallelFor(large.size(), threads, [&](size_t begin, size_t end){
+        Point<T> vertices[Figure<T>::MAX_VERTICES];
+        Point<T> other[Figure<T>::MAX_VERTICES];
+        for (size_t l = begin; l < end; ++l){
+            std::vector<OverlapPair> &pairs = found[chunks + l];
+            size_t i = large[l];
+            for (size_t j = 0; j < n; ++j){
+                // Two large figures are tested once, from the lower index.
+                if (j == i || (is_large[j] && j < i) || !boxes[i].intersects(boxes[j])){
+                    continue;
+                }
+                if (narrowPhase(i, j, vertices, other)){
+                    pairs.emplace_back(std::min(i, j), std::max(i, j));
+                }
+            }
+        }
+    });
+
+    size_t total = 0;
+    for (const auto &pairs : found){
+        total += pairs.size();
+    }
+    std::vector<OverlapPair> merged;
+    merged.reserve(total);
+    for (const auto &pairs : found){
+        merged.insert(merged.end(), pairs.begin(), pairs.end());
+    }
+    parallelSort(merged.data(), merged.size(), threads, std::less<OverlapPair>());
+    Array<OverlapPair> result;
+    result.reserve(total);
+    for (const OverlapPair &pair : merged){
+        result.push_back(pair);
+    }
+    return result;
+}
+
+#endif
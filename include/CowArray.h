@@ -0,0 +1,99 @@
+#ifndef COWARRAY_H
+#define COWARRAY_H
+
+#include "Array.h"
+#include <memory>
+#include <utility>
+
+// Copy-on-write wrapper over Array: copies share one buffer and a private
+// copy is made on the first mutation of a shared instance.
+template<typename T, typename Alloc = std::allocator<T>>
+class CowArray {
+private:
+    std::shared_ptr<Array<T, Alloc>> data_;
+
+    // Shared empty buffer for default-constructed and moved-from instances;
+    // it is never written to because it always has more than one owner.
+    static std::shared_ptr<Array<T, Alloc>> emptyData(){
+        static const std::shared_ptr<Array<T, Alloc>> empty = std::make_shared<Array<T, Alloc>>();
+        return empty;
+    }
+    Array<T, Alloc> &mutableData(){
+        if (data_.use_count() > 1){
+            data_ = std::make_shared<Array<T, Alloc>>(*data_);
+        }
+        return *data_;
+    }
+
+public:
+    using value_type = T;
+
+    CowArray() : data_(emptyData()){}
+    explicit CowArray(size_t size) : data_(std::make_shared<Array<T, Alloc>>(size)){}
+    CowArray(std::initializer_list<T> init) : data_(std::make_shared<Array<T, Alloc>>(init)){}
+    explicit CowArray(Array<T, Alloc> array) : data_(std::make_shared<Array<T, Alloc>>(std::move(array))){}
+    CowArray(const CowArray &other) = default;
+    CowArray(CowArray &&other) noexcept : data_(std::exchange(other.data_, emptyData())){}
+    ~CowArray() = default;
+    CowArray &operator=(const CowArray &other) = default;
+    CowArray &operator=(CowArray &&other) noexcept{
+        if (this != &other){
+            data_ = std::exchange(other.data_, emptyData());
+        }
+        return *this;
+    }
+
+    T &operator[](size_t index){
+        return mutableData()[index];
+    }
+    const T &operator[](size_t index) const{
+        return (*data_)[index];
+    }
+    template<typename... Args>
+    T &emplace_back(Args &&...args){
+        return mutableData().emplace_back(std::forward<Args>(args)...);
+    }
+    void push_back(const T &value){
+        mutableData().push_back(value);
+    }
+    void push_back(T &&value){
+        mutableData().push_back(std::move(value));
+    }
+    void reserve(size_t new_capacity){
+        mutableData().reserve(new_capacity);
+    }
+    void shrink_to_fit(){
+        mutableData().shrink_to_fit();
+    }
+    void remove(size_t index){
+        mutableData().remove(index);
+    }
+    void swap_remove(size_t index){
+        mutableData().swap_remove(index);
+    }
+    void erase(size_t first, size_t last){
+        mutableData().erase(first, last);
+    }
+    template<typename Predicate>
+    size_t erase_if(Predicate pred){
+        return mutableData().erase_if(pred);
+    }
+    void clear(){
+        if (data_.use_count() > 1){
+            data_ = std::make_shared<Array<T, Alloc>>(data_->get_allocator());
+        } else {
+            data_->clear();
+        }
+    }
+    size_t size() const {return data_->size();}
+    size_t capacity() const {return data_->capacity();}
+    bool empty() const {return data_->empty();}
+    bool isShared() const {return data_.use_count() > 1 && data_ != emptyData();}
+    const Array<T, Alloc> &array() const {return *data_;}
+    T* begin() {return mutableData().begin();}
+    const T* begin() const{return data_->begin();}
+    T* end() {return mutableData().end();}
+    const T* end() const{return data_->end();}
+};
+
+#endif
@@ -4,23 +4,55 @@
 #include <vector>
 #include <memory>
 #include <iostream>
+#include <stdexcept>
 #include "Point.h"
+#include "BoundingBox.h"
 
 template<ScalarType T>
 class Figure{
 public:
+    static constexpr size_t MAX_VERTICES = 16;
+
     virtual ~Figure() = default;
     virtual double calculateArea() const = 0;
     virtual Point<T> calculateCenter() const = 0;
-    virtual std::vector<PointPtr<T>> getVertices() const = 0;;
+    virtual std::vector<PointPtr<T>> getVertices() const = 0;
+    virtual size_t vertexCount() const = 0;
+    // Writes vertexCount() points into out (at most MAX_VERTICES), no allocation.
+    virtual size_t writeVertices(Point<T> *out) const = 0;
+    // Tight box around the points writeVertices produces, also for negative
+    // sizes and truncated integer vertices.
+    virtual BoundingBox boundingBox() const = 0;
+    // Short lowercase kind ("rhombus", "hexagon", ...) and the heading
+    // printVertices writes before the points.
+    virtual const char *kindName() const = 0;
+    virtual const char *label() const = 0;
     virtual void printVertices(std::ostream &os) const = 0;
     virtual void read(std::istream &is) = 0;
     virtual bool isEqual(const Figure &other) const = 0;
+    // Agrees with isEqual: equal figures have equal hashes.
+    virtual size_t hashValue() const = 0;
+    // Scene transforms; scaling and rotation are about the pivot point.
+    // A negative scale factor would give negative sizes and an inverted
+    // bounding box, so it throws std::invalid_argument instead.
+    virtual void translate(T dx, T dy) = 0;
+    virtual void scale(T factor, T pivot_x, T pivot_y) = 0;
+    // Shapes keep a fixed orientation, so only quarter turns that map the
+    // shape onto a representable one are allowed; otherwise rotation
+    // returns false and leaves the figure unchanged.
+    virtual bool canRotateQuarterTurns(int quarters) const = 0;
+    virtual bool rotateQuarterTurns(int quarters, T pivot_x, T pivot_y) = 0;
     explicit operator double() const{
         return calculateArea();
     }
 };
 template<ScalarType T>
+void checkScaleFactor(T factor){
+    if (factor < T(0)){
+        throw std::invalid_argument("Scale factor must not be negative");
+    }
+}
+template<ScalarType T>
 std::ostream &operator<<(std::ostream &os, const Figure<T> &figure){
     figure.printVertices(os);
     return os;
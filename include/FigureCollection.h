@@ -0,0 +1,298 @@
+#ifndef FIGURECOLLECTION_H
+#define FIGURECOLLECTION_H
+
+#include "Figure.h"
+#include "Array.h"
+#include "BoundingBox.h"
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+// Neumaier's variant of Kahan summation: the rounding error of every add is
+// kept in a separate term, so the result stays within a few ulps of the
+// exact sum of everything added, including values later subtracted again.
+// Infinities and NaNs are only counted: summed, one would turn both terms
+// into NaN for good, even after it is subtracted again.
+class CompensatedSum{
+private:
+    double sum_ = 0.0;
+    double compensation_ = 0.0;
+    size_t positiveInfinities_ = 0;
+    size_t negativeInfinities_ = 0;
+    size_t nans_ = 0;
+
+    size_t &nonFiniteCount(double value){
+        if (std::isnan(value)){
+            return nans_;
+        }
+        return value > 0.0 ? positiveInfinities_ : negativeInfinities_;
+    }
+    void addFinite(double value){
+        double total = sum_ + value;
+        if (std::abs(sum_) >= std::abs(value)){
+            compensation_ += (sum_ - total) + value;
+        } else {
+            compensation_ += (value - total) + sum_;
+        }
+        sum_ = total;
+    }
+
+public:
+    void add(double value){
+        if (std::isfinite(value)){
+            addFinite(value);
+        } else {
+            ++nonFiniteCount(value);
+        }
+    }
+    // Takes back a value added before.
+    void subtract(double value){
+        if (std::isfinite(value)){
+            addFinite(-value);
+        } else {
+            --nonFiniteCount(value);
+        }
+    }
+    // What summing the values still in would give: NaN, an infinity, or
+    // the compensated finite sum.
+    double value() const{
+        if (nans_ > 0 || (positiveInfinities_ > 0 && negativeInfinities_ > 0)){
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        if (positiveInfinities_ > 0){
+            return std::numeric_limits<double>::infinity();
+        }
+        if (negativeInfinities_ > 0){
+            return -std::numeric_limits<double>::infinity();
+        }
+        return sum_ + compensation_;
+    }
+    void reset(){
+        sum_ = 0.0;
+        compensation_ = 0.0;
+        positiveInfinities_ = 0;
+        negativeInfinities_ = 0;
+        nans_ = 0;
+    }
+};
+
+// Array of figures that keeps its aggregates up to date on every change:
+// total area, per-kind counts, centroid and bounding extent are O(1) to read
+// instead of an O(n) pass like calculateTotalArea. Additions and removals
+// cost O(log n) for the extent and O(1) for the rest.
+//
+// What each figure contributed is recorded when it is added and subtracted
+// exactly on removal. A figure changed in place through its pointer is
+// therefore not seen until update() or recompute(); changes should go
+// through update(index, mutate) or replace().
+template<ScalarType T, typename Alloc = std::allocator<std::shared_ptr<Figure<T>>>>
+class FigureCollection{
+private:
+    struct Contribution{
+        double area = 0.0;
+        double centerX = 0.0;
+        double centerY = 0.0;
+        BoundingBox bounds;
+        const char *kind = nullptr;
+    };
+
+    Array<std::shared_ptr<Figure<T>>, Alloc> figures_;
+    Array<Contribution> contributions_;
+    CompensatedSum area_;
+    CompensatedSum centerX_;
+    CompensatedSum centerY_;
+    CompensatedSum weightedX_;
+    CompensatedSum weightedY_;
+    std::unordered_map<std::string_view, size_t> kindCounts_;
+    // NaN coordinates are left out: they have no place in an ordered set.
+    std::multiset<double> minX_, minY_, maxX_, maxY_;
+
+    static void insertOrdered(std::multiset<double> &values, double value){
+        if (!std::isnan(value)){
+            values.insert(value);
+        }
+    }
+    static void eraseOrdered(std::multiset<double> &values, double value){
+        if (!std::isnan(value)){
+            values.erase(values.find(value));
+        }
+    }
+    static Contribution measure(const Figure<T> &figure){
+        Contribution contribution;
+        Point<T> center = figure.calculateCenter();
+        contribution.area = figure.calculateArea();
+        contribution.centerX = static_cast<double>(center.x());
+        contribution.centerY = static_cast<double>(center.y());
+        contribution.bounds = figure.boundingBox();
+        contribution.kind = figure.kindName();
+        return contribution;
+    }
+    void add(const Contribution &contribution){
+        area_.add(contribution.area);
+        centerX_.add(contribution.centerX);
+        centerY_.add(contribution.centerY);
+        weightedX_.add(contribution.area * contribution.centerX);
+        weightedY_.add(contribution.area * contribution.centerY);
+        ++kindCounts_[contribution.kind];
+        insertOrdered(minX_, contribution.bounds.minX);
+        insertOrdered(minY_, contribution.bounds.minY);
+        insertOrdered(maxX_, contribution.bounds.maxX);
+        insertOrdered(maxY_, contribution.bounds.maxY);
+    }
+    void subtract(const Contribution &contribution){
+        area_.subtract(contribution.area);
+        centerX_.subtract(contribution.centerX);
+        centerY_.subtract(contribution.centerY);
+        weightedX_.subtract(contribution.area * contribution.centerX);
+        weightedY_.subtract(contribution.area * contribution.centerY);
+        auto it = kindCounts_.find(contribution.kind);
+        if (--it->second == 0){
+            kindCounts_.erase(it);
+        }
+        eraseOrdered(minX_, contribution.bounds.minX);
+        eraseOrdered(minY_, contribution.bounds.minY);
+        eraseOrdered(maxX_, contribution.bounds.maxX);
+        eraseOrdered(maxY_, contribution.bounds.maxY);
+    }
+    void checkIndex(size_t index) const{
+        if (index >= figures_.size()){
+            throw std::out_of_range("Index out of range");
+        }
+    }
+    static void checkFigure(const std::shared_ptr<Figure<T>> &figure){
+        if (!figure){
+            throw std::invalid_argument("FigureCollection does not hold null figures");
+        }
+    }
+
+public:
+    FigureCollection() = default;
+    explicit FigureCollection(Array<std::shared_ptr<Figure<T>>, Alloc> figures) : figures_(std::move(figures)){
+        for (size_t i = 0; i < figures_.size(); ++i){
+            checkFigure(figures_[i]);
+        }
+        recompute();
+    }
+
+    const std::shared_ptr<Figure<T>> &operator[](size_t index) const{
+        return figures_[index];
+    }
+    const Array<std::shared_ptr<Figure<T>>, Alloc> &figures() const {return figures_;}
+    size_t size() const {return figures_.size();}
+    bool empty() const {return figures_.empty();}
+    const std::shared_ptr<Figure<T>> *begin() const {return figures_.begin();}
+    const std::shared_ptr<Figure<T>> *end() const {return figures_.end();}
+
+    void push_back(std::shared_ptr<Figure<T>> figure){
+        checkFigure(figure);
+        Contribution contribution = measure(*figure);
+        contributions_.push_back(contribution);
+        try{
+            figures_.push_back(std::move(figure));
+        } catch (...){
+            contributions_.remove(contributions_.size() - 1);
+            throw;
+        }
+        add(contribution);
+    }
+    // Keeps the order of the remaining figures, like Array::remove.
+    void remove(size_t index){
+        checkIndex(index);
+        subtract(contributions_[index]);
+        figures_.remove(index);
+        contributions_.remove(index);
+    }
+    void swap_remove(size_t index){
+        checkIndex(index);
+        subtract(contributions_[index]);
+        figures_.swap_remove(index);
+        contributions_.swap_remove(index);
+    }
+    void replace(size_t index, std::shared_ptr<Figure<T>> figure){
+        checkIndex(index);
+        checkFigure(figure);
+        Contribution contribution = measure(*figure);
+        subtract(contributions_[index]);
+        figures_[index] = std::move(figure);
+        contributions_[index] = contribution;
+        add(contribution);
+    }
+    // Runs mutate(figure) and refreshes that figure's contribution.
+    template<typename Mutate>
+    void update(size_t index, Mutate mutate){
+        checkIndex(index);
+        subtract(contributions_[index]);
+        try{
+            mutate(*figures_[index]);
+        } catch (...){
+            contributions_[index] = measure(*figures_[index]);
+            add(contributions_[index]);
+            throw;
+        }
+        contributions_[index] = measure(*figures_[index]);
+        add(contributions_[index]);
+    }
+    void clear(){
+        figures_.clear();
+        contributions_.clear();
+        recompute();
+    }
+    // Rebuilds every aggregate from the figures as they are now.
+    void recompute(){
+        area_.reset();
+        centerX_.reset();
+        centerY_.reset();
+        weightedX_.reset();
+        weightedY_.reset();
+        kindCounts_.clear();
+        minX_.clear();
+        minY_.clear();
+        maxX_.clear();
+        maxY_.clear();
+        contributions_.clear();
+        contributions_.reserve(figures_.size());
+        for (size_t i = 0; i < figures_.size(); ++i){
+            contributions_.push_back(measure(*figures_[i]));
+            add(contributions_[i]);
+        }
+    }
+
+    double totalArea() const {return area_.value();}
+    size_t countOfKind(std::string_view kind) const{
+        auto it = kindCounts_.find(kind);
+        return it == kindCounts_.end() ? 0 : it->second;
+    }
+    const std::unordered_map<std::string_view, size_t> &kindCounts() const {return kindCounts_;}
+    // Mean of the figure centers; (0, 0) when empty.
+    Point<double> centroid() const{
+        if (figures_.empty()){
+            return Point<double>();
+        }
+        double count = static_cast<double>(figures_.size());
+        return Point<double>(centerX_.value() / count, centerY_.value() / count);
+    }
+    // Figure centers weighted by area; (0, 0) when the total area is zero.
+    Point<double> areaWeightedCentroid() const{
+        double area = totalArea();
+        if (area == 0.0){
+            return Point<double>();
+        }
+        return Point<double>(weightedX_.value() / area, weightedY_.value() / area);
+    }
+    // Union of the figures' bounding boxes; empty() when there are none.
+    BoundingBox extent() const{
+        BoundingBox box;
+        if (!minX_.empty()) box.minX = *minX_.begin();
+        if (!minY_.empty()) box.minY = *minY_.begin();
+        if (!maxX_.empty()) box.maxX = *maxX_.rbegin();
+        if (!maxY_.empty()) box.maxY = *maxY_.rbegin();
+        return box;
+    }
+};
+
+#endif
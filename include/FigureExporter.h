@@ -0,0 +1,174 @@
+#ifndef FIGUREEXPORTER_H
+#define FIGUREEXPORTER_H
+
+#include "Figure.h"
+#include "Array.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <type_traits>
+
+enum class ExportFormat{
+    // Same layout as operator<<: the label line, then "(x, y)" per vertex.
+    TEXT,
+    // Header "figure,kind,vertex,x,y", then one row per vertex.
+    CSV,
+    // One object per figure: {"kind":"hexagon","vertices":[[x,y],...]}.
+    JSON_LINES
+};
+
+// Formats figures with std::to_chars into one reusable buffer and hands it
+// to the stream in large chunks. TEXT keeps the 6 significant digits of the
+// default ostream format; CSV and JSON_LINES use the shortest representation
+// that reads back to the same value.
+class FigureWriter{
+private:
+    // Longest number to_chars can produce for any arithmetic type.
+    static constexpr size_t MAX_NUMBER = 64;
+    static constexpr size_t MIN_BUFFER_SIZE = 1024;
+
+    std::ostream &os_;
+    ExportFormat format_;
+    std::unique_ptr<char[]> buffer_;
+    size_t capacity_;
+    size_t used_;
+    size_t figures_;
+
+    void reserve(size_t bytes){
+        if (capacity_ - used_ < bytes){
+            flush();
+        }
+    }
+    void put(char c){
+        reserve(1);
+        buffer_[used_++] = c;
+    }
+    void put(const char *text){
+        size_t length = std::strlen(text);
+        while (length > 0){
+            reserve(1);
+            size_t chunk = std::min(length, capacity_ - used_);
+            std::memcpy(buffer_.get() + used_, text, chunk);
+            used_ += chunk;
+            text += chunk;
+            length -= chunk;
+        }
+    }
+    void putUnsigned(size_t value){
+        reserve(MAX_NUMBER);
+        used_ = static_cast<size_t>(std::to_chars(buffer_.get() + used_, buffer_.get() + capacity_, value).ptr - buffer_.get());
+    }
+    template<typename T>
+    void putNumber(T value){
+        static_assert(std::is_arithmetic_v<T>, "figures are exported as arithmetic scalars only");
+        reserve(MAX_NUMBER);
+        char *first = buffer_.get() + used_;
+        char *last = buffer_.get() + capacity_;
+        std::to_chars_result result;
+        if constexpr (std::is_floating_point_v<T>){
+            if (format_ == ExportFormat::JSON_LINES && !std::isfinite(value)){
+                put("null");
+                return;
+            }
+            result = format_ == ExportFormat::TEXT ? std::to_chars(first, last, value, std::chars_format::general, 6)
+                                                    : std::to_chars(first, last, value);
+        } else if constexpr (std::is_same_v<T, bool>){
+            result = std::to_chars(first, last, static_cast<int>(value));
+        } else {
+            result = std::to_chars(first, last, value);
+        }
+        used_ = static_cast<size_t>(result.ptr - buffer_.get());
+    }
+
+public:
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1 << 16;
+
+    explicit FigureWriter(std::ostream &os, ExportFormat format = ExportFormat::TEXT, size_t buffer_size = DEFAULT_BUFFER_SIZE)
+        : os_(os), format_(format), capacity_(std::max(buffer_size, MIN_BUFFER_SIZE)), used_(0), figures_(0){
+        buffer_ = std::make_unique<char[]>(capacity_);
+        if (format_ == ExportFormat::CSV){
+            put("figure,kind,vertex,x,y\n");
+        }
+    }
+    FigureWriter(const FigureWriter &) = delete;
+    FigureWriter &operator=(const FigureWriter &) = delete;
+    ~FigureWriter(){
+        try{
+            flush();
+        } catch (...){
+        }
+    }
+
+    template<ScalarType T>
+    void write(const Figure<T> &figure){
+        Point<T> vertices[Figure<T>::MAX_VERTICES];
+        size_t count = figure.writeVertices(vertices);
+        switch (format_){
+            case ExportFormat::TEXT:
+                put(figure.label());
+                put('\n');
+                for (size_t i = 0; i < count; ++i){
+                    put('(');
+                    putNumber(vertices[i].x());
+                    put(", ");
+                    putNumber(vertices[i].y());
+                    put(")\n");
+                }
+                break;
+            case ExportFormat::CSV:
+                for (size_t i = 0; i < count; ++i){
+                    putUnsigned(figures_);
+                    put(',');
+                    put(figure.kindName());
+                    put(',');
+                    putUnsigned(i);
+                    put(',');
+                    putNumber(vertices[i].x());
+                    put(',');
+                    putNumber(vertices[i].y());
+                    put('\n');
+                }
+                break;
+            case ExportFormat::JSON_LINES:
+                put("{\"kind\":\"");
+                put(figure.kindName());
+                put("\",\"vertices\":[");
+                for (size_t i = 0; i < count; ++i){
+                    put(i == 0 ? "[" : ",[");
+                    putNumber(vertices[i].x());
+                    put(',');
+                    putNumber(vertices[i].y());
+                    put(']');
+                }
+                put("]}\n");
+                break;
+        }
+        ++figures_;
+    }
+    template<ScalarType T, typename Alloc>
+    void write(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures){
+        for (size_t i = 0; i < figures.size(); ++i){
+            write(*figures[i]);
+        }
+    }
+    void flush(){
+        if (used_ > 0){
+            os_.write(buffer_.get(), static_cast<std::streamsize>(used_));
+            used_ = 0;
+        }
+    }
+    size_t figuresWritten() const {return figures_;}
+    ExportFormat format() const {return format_;}
+};
+
+template<ScalarType T, typename Alloc>
+void exportFigures(std::ostream &os, const Array<std::shared_ptr<Figure<T>>, Alloc> &figures, ExportFormat format = ExportFormat::TEXT){
+    FigureWriter writer(os, format);
+    writer.write(figures);
+    writer.flush();
+}
+
+#endif
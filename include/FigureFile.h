@@ -0,0 +1,319 @@
+#ifndef FIGUREFILE_H
+#define FIGUREFILE_H
+
+#include "Figure.h"
+#include "FigureStore.h"
+#include "Array.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Binary figure file, version 1:
+//   FigureFileHeader (64 bytes)
+//   rhombus section:  counts[0] x FigureFileRhombus<T>
+//   pentagon section: counts[1] x FigureFilePolygon<T>
+//   hexagon section:  counts[2] x FigureFilePolygon<T>
+// Sections start at 16-byte aligned offsets, values are in host byte order
+// (checked through byteOrder), and the scalar type is recorded so a file is
+// only opened with the T it was written with.
+constexpr uint32_t FIGURE_FILE_BYTE_ORDER = 0x01020304;
+constexpr uint16_t FIGURE_FILE_VERSION = 1;
+constexpr size_t FIGURE_FILE_ALIGNMENT = 16;
+
+enum FigureFileSection : size_t{
+    RHOMBUS_SECTION = 0,
+    PENTAGON_SECTION = 1,
+    HEXAGON_SECTION = 2,
+    FIGURE_FILE_SECTIONS = 3
+};
+
+struct FigureFileHeader{
+    char magic[4];
+    uint32_t byteOrder;
+    uint16_t version;
+    uint8_t scalarKind;
+    uint8_t scalarSize;
+    uint32_t reserved;
+    uint64_t counts[FIGURE_FILE_SECTIONS];
+    uint64_t offsets[FIGURE_FILE_SECTIONS];
+};
+static_assert(sizeof(FigureFileHeader) == 64, "FigureFileHeader layout changed");
+
+template<ScalarType T>
+struct FigureFileRhombus{
+    T x;
+    T y;
+    T diagonal1;
+    T diagonal2;
+};
+
+template<ScalarType T>
+struct FigureFilePolygon{
+    T x;
+    T y;
+    T side;
+};
+
+template<ScalarType T>
+constexpr uint8_t figureFileScalarKind(){
+    static_assert(std::is_arithmetic_v<T>, "figure files store arithmetic scalars only");
+    if constexpr (std::is_floating_point_v<T>){
+        return 2;
+    } else if constexpr (std::is_signed_v<T>){
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
+inline uint64_t alignFigureFileOffset(uint64_t offset){
+    return (offset + FIGURE_FILE_ALIGNMENT - 1) / FIGURE_FILE_ALIGNMENT * FIGURE_FILE_ALIGNMENT;
+}
+
+template<ScalarType T>
+void writeFigureFile(const std::string &path, const FigureStore<T> &store){
+    FigureFileHeader header{};
+    std::memcpy(header.magic, "FIGB", 4);
+    header.byteOrder = FIGURE_FILE_BYTE_ORDER;
+    header.version = FIGURE_FILE_VERSION;
+    header.scalarKind = figureFileScalarKind<T>();
+    header.scalarSize = sizeof(T);
+    header.counts[RHOMBUS_SECTION] = store.rhombusCount();
+    header.counts[PENTAGON_SECTION] = store.pentagonCount();
+    header.counts[HEXAGON_SECTION] = store.hexagonCount();
+    header.offsets[RHOMBUS_SECTION] = alignFigureFileOffset(sizeof(FigureFileHeader));
+    header.offsets[PENTAGON_SECTION] = alignFigureFileOffset(header.offsets[RHOMBUS_SECTION] + store.rhombusCount() * sizeof(FigureFileRhombus<T>));
+    header.offsets[HEXAGON_SECTION] = alignFigureFileOffset(header.offsets[PENTAGON_SECTION] + store.pentagonCount() * sizeof(FigureFilePolygon<T>));
+
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    if (!os){
+        throw std::runtime_error("writeFigureFile: cannot open " + path);
+    }
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Records are staged in fixed-size chunks so memory stays bounded.
+    static constexpr size_t CHUNK = 4096;
+    auto pad = [&os](uint64_t offset){
+        static const char zeros[FIGURE_FILE_ALIGNMENT] = {};
+        os.write(zeros, static_cast<std::streamsize>(offset - static_cast<uint64_t>(os.tellp())));
+    };
+    auto writeSection = [&os](auto &chunk, size_t count, auto fill){
+        for (size_t first = 0; first < count; first += CHUNK){
+            size_t n = std::min(CHUNK, count - first);
+            for (size_t i = 0; i < n; ++i){
+                chunk[i] = fill(first + i);
+            }
+            os.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(n * sizeof(chunk[0])));
+        }
+    };
+
+    pad(header.offsets[RHOMBUS_SECTION]);
+    std::vector<FigureFileRhombus<T>> rhombuses(CHUNK);
+    const auto &r = store.rhombuses();
+    writeSection(rhombuses, store.rhombusCount(), [&r](size_t i){
+        return FigureFileRhombus<T>{r.x[i], r.y[i], r.diagonal1[i], r.diagonal2[i]};
+    });
+    std::vector<FigureFilePolygon<T>> polygons(CHUNK);
+    pad(header.offsets[PENTAGON_SECTION]);
+    const auto &p = store.pentagons();
+    writeSection(polygons, store.pentagonCount(), [&p](size_t i){
+        return FigureFilePolygon<T>{p.x[i], p.y[i], p.side[i]};
+    });
+    pad(header.offsets[HEXAGON_SECTION]);
+    const auto &h = store.hexagons();
+    writeSection(polygons, store.hexagonCount(), [&h](size_t i){
+        return FigureFilePolygon<T>{h.x[i], h.y[i], h.side[i]};
+    });
+    if (!os.flush()){
+        throw std::runtime_error("writeFigureFile: write failed for " + path);
+    }
+}
+
+template<ScalarType T, typename Alloc>
+void writeFigureFile(const std::string &path, const Array<std::shared_ptr<Figure<T>>, Alloc> &figures){
+    FigureStore<T> store;
+    for (size_t i = 0; i < figures.size(); ++i){
+        store.add(*figures[i]);
+    }
+    writeFigureFile(path, store);
+}
+
+// Read-only memory mapping of a figure file. Records are used in place:
+// nothing is parsed or copied until a caller asks for it.
+template<ScalarType T>
+class MappedFigureFile{
+private:
+    const unsigned char *data_;
+    size_t size_;
+    const FigureFileHeader *header_;
+
+    void validate(const std::string &path) const{
+        auto fail = [&path](const char *reason){
+            throw std::runtime_error("MappedFigureFile: " + path + ": " + reason);
+        };
+        if (size_ < sizeof(FigureFileHeader)){
+            fail("file too small");
+        }
+        if (std::memcmp(header_->magic, "FIGB", 4) != 0){
+            fail("bad magic");
+        }
+        if (header_->byteOrder != FIGURE_FILE_BYTE_ORDER){
+            fail("byte order mismatch");
+        }
+        if (header_->version != FIGURE_FILE_VERSION){
+            fail("unsupported version");
+        }
+        if (header_->scalarKind != figureFileScalarKind<T>() || header_->scalarSize != sizeof(T)){
+            fail("scalar type mismatch");
+        }
+        const size_t record_sizes[FIGURE_FILE_SECTIONS] = {sizeof(FigureFileRhombus<T>), sizeof(FigureFilePolygon<T>), sizeof(FigureFilePolygon<T>)};
+        for (size_t section = 0; section < FIGURE_FILE_SECTIONS; ++section){
+            uint64_t offset = header_->offsets[section];
+            uint64_t count = header_->counts[section];
+            if (offset % alignof(T) != 0 || offset > size_ || count > (size_ - offset) / record_sizes[section]){
+                fail("section out of bounds");
+            }
+        }
+    }
+    static double sideSquares(const FigureFilePolygon<T> *records, size_t count){
+        double total = 0.0;
+        for (size_t i = 0; i < count; ++i){
+            double side = static_cast<double>(records[i].side);
+            total += side * side;
+        }
+        return total;
+    }
+    template<typename Record>
+    const Record *section(FigureFileSection index) const{
+        return reinterpret_cast<const Record*>(data_ + header_->offsets[index]);
+    }
+
+public:
+    explicit MappedFigureFile(const std::string &path) : data_(nullptr), size_(0), header_(nullptr){
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0){
+            throw std::runtime_error("MappedFigureFile: cannot open " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0){
+            ::close(fd);
+            throw std::runtime_error("MappedFigureFile: cannot stat " + path);
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        void *mapped = size_ > 0 ? ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (mapped == MAP_FAILED){
+            throw std::runtime_error("MappedFigureFile: cannot map " + path);
+        }
+        data_ = static_cast<const unsigned char*>(mapped);
+        header_ = reinterpret_cast<const FigureFileHeader*>(data_);
+        try{
+            validate(path);
+        } catch (...){
+            ::munmap(const_cast<unsigned char*>(data_), size_);
+            throw;
+        }
+    }
+    MappedFigureFile(const MappedFigureFile &) = delete;
+    MappedFigureFile &operator=(const MappedFigureFile &) = delete;
+    MappedFigureFile(MappedFigureFile &&other) noexcept : data_(other.data_), size_(other.size_), header_(other.header_){
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.header_ = nullptr;
+    }
+    ~MappedFigureFile(){
+        if (data_){
+            ::munmap(const_cast<unsigned char*>(data_), size_);
+        }
+    }
+
+    const FigureFileHeader &header() const {return *header_;}
+    size_t rhombusCount() const {return header_->counts[RHOMBUS_SECTION];}
+    size_t pentagonCount() const {return header_->counts[PENTAGON_SECTION];}
+    size_t hexagonCount() const {return header_->counts[HEXAGON_SECTION];}
+    size_t size() const {return rhombusCount() + pentagonCount() + hexagonCount();}
+    const FigureFileRhombus<T> *rhombuses() const {return section<FigureFileRhombus<T>>(RHOMBUS_SECTION);}
+    const FigureFilePolygon<T> *pentagons() const {return section<FigureFilePolygon<T>>(PENTAGON_SECTION);}
+    const FigureFilePolygon<T> *hexagons() const {return section<FigureFilePolygon<T>>(HEXAGON_SECTION);}
+
+    double rhombusArea() const{
+        const FigureFileRhombus<T> *records = rhombuses();
+        double total = 0.0;
+        for (size_t i = 0; i < rhombusCount(); ++i){
+            total += static_cast<double>(records[i].diagonal1 * records[i].diagonal2);
+        }
+        return total / 2.0;
+    }
+    double pentagonArea() const{
+        return RegularPolygonTable<5>::AREA_COEFFICIENT * sideSquares(pentagons(), pentagonCount());
+    }
+    double hexagonArea() const{
+        return RegularPolygonTable<6>::AREA_COEFFICIENT * sideSquares(hexagons(), hexagonCount());
+    }
+    double totalArea() const{
+        return rhombusArea() + pentagonArea() + hexagonArea();
+    }
+
+    // Calls fn(const Figure<T> &) for every record with a shape built on the
+    // stack, so iteration never allocates.
+    template<typename Fn>
+    void forEachFigure(Fn fn) const{
+        for (size_t i = 0; i < rhombusCount(); ++i){
+            const auto &record = rhombuses()[i];
+            fn(static_cast<const Figure<T>&>(Rhombus<T>(record.diagonal1, record.diagonal2, record.x, record.y)));
+        }
+        for (size_t i = 0; i < pentagonCount(); ++i){
+            const auto &record = pentagons()[i];
+            fn(static_cast<const Figure<T>&>(Pentagon<T>(record.side, record.x, record.y)));
+        }
+        for (size_t i = 0; i < hexagonCount(); ++i){
+            const auto &record = hexagons()[i];
+            fn(static_cast<const Figure<T>&>(Hexagon<T>(record.side, record.x, record.y)));
+        }
+    }
+    FigureStore<T> toStore() const{
+        FigureStore<T> store;
+        for (size_t i = 0; i < rhombusCount(); ++i){
+            const auto &record = rhombuses()[i];
+            store.addRhombus(record.diagonal1, record.diagonal2, record.x, record.y);
+        }
+        for (size_t i = 0; i < pentagonCount(); ++i){
+            const auto &record = pentagons()[i];
+            store.addPentagon(record.side, record.x, record.y);
+        }
+        for (size_t i = 0; i < hexagonCount(); ++i){
+            const auto &record = hexagons()[i];
+            store.addHexagon(record.side, record.x, record.y);
+        }
+        return store;
+    }
+    Array<std::shared_ptr<Figure<T>>> toArray() const{
+        Array<std::shared_ptr<Figure<T>>> figures;
+        figures.reserve(size());
+        for (size_t i = 0; i < rhombusCount(); ++i){
+            const auto &record = rhombuses()[i];
+            figures.push_back(std::make_shared<Rhombus<T>>(record.diagonal1, record.diagonal2, record.x, record.y));
+        }
+        for (size_t i = 0; i < pentagonCount(); ++i){
+            const auto &record = pentagons()[i];
+            figures.push_back(std::make_shared<Pentagon<T>>(record.side, record.x, record.y));
+        }
+        for (size_t i = 0; i < hexagonCount(); ++i){
+            const auto &record = hexagons()[i];
+            figures.push_back(std::make_shared<Hexagon<T>>(record.side, record.x, record.y));
+        }
+        return figures;
+    }
+};
+
+#endif
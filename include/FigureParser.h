@@ -0,0 +1,205 @@
+#ifndef FIGUREPARSER_H
+#define FIGUREPARSER_H
+
+#include "Figure.h"
+#include "Rhombus.h"
+#include "Pentagon.h"
+#include "Hexagon.h"
+#include "FigureStore.h"
+#include "Array.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Non-interactive bulk format, one figure per line:
+//   R diagonal1 diagonal2 x y
+//   P side x y
+//   H side x y
+// Fields are separated by spaces or tabs; blank lines and lines starting
+// with '#' are skipped.
+class FigureParseError : public std::runtime_error{
+private:
+    size_t line_;
+
+public:
+    FigureParseError(size_t line, const std::string &message)
+        : std::runtime_error("line " + std::to_string(line) + ": " + message), line_(line){}
+    size_t line() const {return line_;}
+};
+
+// Plain decimals ("-12.375", "7", ".5") with at most 15 digits convert
+// exactly: the digits form an integer below 2^53 and 10^k is exact for
+// k <= 15, so the one division is correctly rounded and gives the same
+// double as from_chars. Anything else (exponents, long mantissas, inf, nan)
+// returns nullptr and goes to from_chars.
+inline const char *parseShortDecimal(const char *first, const char *last, double &value){
+    static constexpr double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+                                               1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+    const char *p = first;
+    bool negative = p != last && *p == '-';
+    if (negative){
+        ++p;
+    }
+    uint64_t mantissa = 0;
+    size_t digits = 0;
+    size_t fraction = 0;
+    for (; p != last && static_cast<unsigned>(*p - '0') < 10; ++p, ++digits){
+        mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+    }
+    if (p != last && *p == '.'){
+        for (++p; p != last && static_cast<unsigned>(*p - '0') < 10; ++p, ++digits, ++fraction){
+            mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+        }
+    }
+    if (digits == 0 || digits > 15 || (p != last && (*p == 'e' || *p == 'E'))){
+        return nullptr;
+    }
+    double result = static_cast<double>(mantissa) / POWERS_OF_TEN[fraction];
+    value = negative ? -result : result;
+    return p;
+}
+
+template<typename T>
+std::from_chars_result parseNumber(const char *first, const char *last, T &value){
+    if constexpr (std::is_same_v<T, double>){
+        if (const char *end = parseShortDecimal(first, last, value)){
+            return {end, std::errc()};
+        }
+    }
+    return std::from_chars(first, last, value);
+}
+
+// Calls onFigure(tag, values) for every figure line; values holds 4 numbers
+// for 'R' and 3 for 'P' / 'H'. Errors are reported with line numbers counted
+// from first_line, so a text split into pieces keeps the original numbering.
+template<ScalarType T, typename OnFigure>
+void parseFigureLines(std::string_view text, OnFigure onFigure, size_t first_line = 1){
+    static_assert(std::is_arithmetic_v<T>, "figure text holds arithmetic scalars only");
+    const char *cursor = text.data();
+    const char *end = text.data() + text.size();
+    size_t line = first_line - 1;
+    auto skipBlanks = [](const char *p, const char *stop){
+        while (p != stop && (*p == ' ' || *p == '\t' || *p == '\r')){
+            ++p;
+        }
+        return p;
+    };
+    while (cursor != end){
+        ++line;
+        const char *line_end = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<size_t>(end - cursor)));
+        if (!line_end){
+            line_end = end;
+        }
+        const char *p = skipBlanks(cursor, line_end);
+        cursor = line_end == end ? end : line_end + 1;
+        if (p == line_end || *p == '#'){
+            continue;
+        }
+        char tag = *p++;
+        size_t expected;
+        switch (tag){
+            case 'R': expected = 4; break;
+            case 'P': case 'H': expected = 3; break;
+            default: throw FigureParseError(line, std::string("unknown figure tag '") + tag + "'");
+        }
+        if (p != line_end && *p != ' ' && *p != '\t'){
+            throw FigureParseError(line, "figure tag must be a single character");
+        }
+        T values[4];
+        for (size_t i = 0; i < expected; ++i){
+            p = skipBlanks(p, line_end);
+            if (p == line_end){
+                throw FigureParseError(line, "expected " + std::to_string(expected) + " numbers after '" + tag + "'");
+            }
+            auto [next, error] = parseNumber(p, line_end, values[i]);
+            if (error != std::errc() || (next != line_end && *next != ' ' && *next != '\t' && *next != '\r')){
+                throw FigureParseError(line, "invalid number in field " + std::to_string(i + 1));
+            }
+            p = next;
+        }
+        if (skipBlanks(p, line_end) != line_end){
+            throw FigureParseError(line, "unexpected trailing data");
+        }
+        onFigure(tag, static_cast<const T*>(values));
+    }
+}
+
+// Upper bound on the number of figure lines, used to size the output once.
+inline size_t countLines(std::string_view text){
+    return static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) + 1;
+}
+
+// Builds the figure for one parsed line.
+template<ScalarType T>
+std::shared_ptr<Figure<T>> makeParsedFigure(char tag, const T *v){
+    if (tag == 'R'){
+        return std::make_shared<Rhombus<T>>(v[0], v[1], v[2], v[3]);
+    } else if (tag == 'P'){
+        return std::make_shared<Pentagon<T>>(v[0], v[1], v[2]);
+    }
+    return std::make_shared<Hexagon<T>>(v[0], v[1], v[2]);
+}
+
+template<ScalarType T>
+Array<std::shared_ptr<Figure<T>>> parseFigures(std::string_view text){
+    Array<std::shared_ptr<Figure<T>>> figures;
+    figures.reserve(countLines(text));
+    parseFigureLines<T>(text, [&figures](char tag, const T *v){
+        figures.push_back(makeParsedFigure<T>(tag, v));
+    });
+    return figures;
+}
+
+template<ScalarType T>
+FigureStore<T> parseFigureStore(std::string_view text){
+    FigureStore<T> store;
+    parseFigureLines<T>(text, [&store](char tag, const T *v){
+        if (tag == 'R'){
+            store.addRhombus(v[0], v[1], v[2], v[3]);
+        } else if (tag == 'P'){
+            store.addPentagon(v[0], v[1], v[2]);
+        } else {
+            store.addHexagon(v[0], v[1], v[2]);
+        }
+    });
+    return store;
+}
+
+// Reads the whole stream into one buffer and parses it in a single pass.
+inline std::string readWholeStream(std::istream &is){
+    return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+inline std::string readWholeFile(const std::string &path){
+    std::ifstream is(path, std::ios::binary | std::ios::ate);
+    if (!is){
+        throw std::runtime_error("cannot open " + path);
+    }
+    std::string buffer(static_cast<size_t>(is.tellg()), '\0');
+    is.seekg(0);
+    if (!is.read(buffer.data(), static_cast<std::streamsize>(buffer.size()))){
+        throw std::runtime_error("cannot read " + path);
+    }
+    return buffer;
+}
+
+template<ScalarType T>
+Array<std::shared_ptr<Figure<T>>> parseFigures(std::istream &is){
+    return parseFigures<T>(std::string_view(readWholeStream(is)));
+}
+
+template<ScalarType T>
+Array<std::shared_ptr<Figure<T>>> parseFigureFile(const std::string &path){
+    return parseFigures<T>(std::string_view(readWholeFile(path)));
+}
+
+#endif
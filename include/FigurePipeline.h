@@ -0,0 +1,204 @@
+#ifndef FIGUREPIPELINE_H
+#define FIGUREPIPELINE_H
+
+#include "Figure.h"
+#include "Array.h"
+#include "BoundingBox.h"
+#include "FigureParser.h"
+#include "SpscQueue.h"
+#include <algorithm>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+struct FigurePipelineOptions{
+    // Figures (or compute results) handed between stages at a time.
+    size_t batchSize = 256;
+    // Batches each queue holds before the stage feeding it has to wait.
+    size_t queueBatches = 16;
+    // Bytes read from the stream per call.
+    size_t readChunk = 1 << 16;
+    // Longest unfinished line the parse stage carries between reads; a line
+    // still open past it is a parse error.
+    size_t maxLineLength = 1 << 20;
+};
+
+// Streams figures in the FigureParser text format through three stages:
+//   parse     (own thread)  text -> std::shared_ptr<Figure<T>>
+//   compute   (own thread)  compute(const Figure<T>&) -> R
+//   aggregate (caller)      aggregate(R&&)
+// connected by bounded SpscQueues of batches. Memory is bounded by the
+// options, not by the input: a full queue stalls the stage before it,
+// figures are freed as soon as compute is done with their batch, and a line
+// still unfinished after maxLineLength bytes is rejected instead of
+// buffered. Results reach aggregate in input order.
+//
+// The first exception from any stage (including FigureParseError with the
+// line number in the whole stream) stops the other stages and is rethrown.
+template<ScalarType T, typename Compute, typename Aggregate>
+void runFigurePipeline(std::istream &is, Compute compute, Aggregate aggregate, const FigurePipelineOptions &options = FigurePipelineOptions()){
+    using Result = std::decay_t<std::invoke_result_t<Compute&, const Figure<T>&>>;
+    using FigureBatch = Array<std::shared_ptr<Figure<T>>>;
+    using ResultBatch = Array<Result>;
+    size_t batch_size = std::max<size_t>(options.batchSize, 1);
+    size_t read_chunk = std::max<size_t>(options.readChunk, 1);
+    size_t max_line = std::max<size_t>(options.maxLineLength, 1);
+    SpscQueue<FigureBatch> figure_queue(options.queueBatches);
+    SpscQueue<ResultBatch> result_queue(options.queueBatches);
+
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto fail = [&]{
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error){
+                error = std::current_exception();
+            }
+        }
+        figure_queue.cancel();
+        result_queue.cancel();
+    };
+
+    std::thread parser([&]{
+        try{
+            FigureBatch batch;
+            batch.reserve(batch_size);
+            bool running = true;
+            auto onFigure = [&](char tag, const T *values){
+                batch.push_back(makeParsedFigure<T>(tag, values));
+                if (batch.size() == batch_size && running){
+                    running = figure_queue.push(std::move(batch));
+                    batch = FigureBatch();
+                    batch.reserve(batch_size);
+                }
+            };
+            // Only complete lines are parsed; the tail of each read waits
+            // for the next one.
+            std::string buffer;
+            size_t line = 1;
+            while (running && is){
+                // buffer holds only the unfinished line here.
+                if (buffer.size() > max_line){
+                    throw FigureParseError(line, "line longer than " + std::to_string(max_line) + " bytes");
+                }
+                size_t kept = buffer.size();
+                buffer.resize(kept + read_chunk);
+                is.read(buffer.data() + kept, static_cast<std::streamsize>(read_chunk));
+                buffer.resize(kept + static_cast<size_t>(is.gcount()));
+                size_t last_newline = buffer.rfind('\n');
+                if (last_newline == std::string::npos){
+                    continue;
+                }
+                std::string_view complete(buffer.data(), last_newline + 1);
+                parseFigureLines<T>(complete, onFigure, line);
+                line += static_cast<size_t>(std::count(complete.begin(), complete.end(), '\n'));
+                buffer.erase(0, last_newline + 1);
+            }
+            if (running && buffer.size() > max_line){
+                throw FigureParseError(line, "line longer than " + std::to_string(max_line) + " bytes");
+            }
+            if (running && !buffer.empty()){
+                parseFigureLines<T>(buffer, onFigure, line);
+            }
+            if (running && !batch.empty()){
+                figure_queue.push(std::move(batch));
+            }
+            figure_queue.close();
+        } catch (...){
+            fail();
+        }
+    });
+
+    // If the second thread cannot start, the parser has to be stopped and
+    // joined before the exception leaves, or its destructor terminates.
+    std::thread computer;
+    try{
+        computer = std::thread([&]{
+            try{
+                FigureBatch figures;
+                while (figure_queue.pop(figures)){
+                    ResultBatch results;
+                    results.reserve(figures.size());
+                    for (size_t i = 0; i < figures.size(); ++i){
+                        results.push_back(compute(static_cast<const Figure<T>&>(*figures[i])));
+                    }
+                    figures = FigureBatch();
+                    if (!result_queue.push(std::move(results))){
+                        break;
+                    }
+                }
+                result_queue.close();
+            } catch (...){
+                fail();
+            }
+        });
+    } catch (...){
+        figure_queue.cancel();
+        parser.join();
+        throw;
+    }
+
+    try{
+        ResultBatch results;
+        while (result_queue.pop(results)){
+            for (size_t i = 0; i < results.size(); ++i){
+                aggregate(std::move(results[i]));
+            }
+        }
+    } catch (...){
+        fail();
+    }
+    parser.join();
+    computer.join();
+    if (error){
+        std::rethrow_exception(error);
+    }
+}
+
+// Per-figure values computed by streamFigureTotals.
+struct FigureMetrics{
+    double area = 0.0;
+    size_t vertexCount = 0;
+    BoundingBox bounds;
+};
+
+struct FigureStreamTotals{
+    size_t figures = 0;
+    size_t vertices = 0;
+    // Summed in input order, so equal to calculateTotalArea() of the same
+    // figures loaded into an Array.
+    double totalArea = 0.0;
+    BoundingBox bounds;
+};
+
+template<ScalarType T>
+FigureMetrics computeFigureMetrics(const Figure<T> &figure){
+    Point<T> vertices[Figure<T>::MAX_VERTICES];
+    FigureMetrics metrics;
+    metrics.area = figure.calculateArea();
+    metrics.vertexCount = figure.writeVertices(vertices);
+    for (size_t i = 0; i < metrics.vertexCount; ++i){
+        metrics.bounds.expand(static_cast<double>(vertices[i].x()), static_cast<double>(vertices[i].y()));
+    }
+    return metrics;
+}
+
+template<ScalarType T>
+FigureStreamTotals streamFigureTotals(std::istream &is, const FigurePipelineOptions &options = FigurePipelineOptions()){
+    FigureStreamTotals totals;
+    runFigurePipeline<T>(is, computeFigureMetrics<T>, [&totals](FigureMetrics &&metrics){
+        ++totals.figures;
+        totals.vertices += metrics.vertexCount;
+        totals.totalArea += metrics.area;
+        totals.bounds.expand(metrics.bounds);
+    }, options);
+    return totals;
+}
+
+#endif
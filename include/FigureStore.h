@@ -0,0 +1,261 @@
+#ifndef FIGURESTORE_H
+#define FIGURESTORE_H
+
+#include "Figure.h"
+#include "Rhombus.h"
+#include "Pentagon.h"
+#include "Hexagon.h"
+#include "Array.h"
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+// Lane-blocked reductions: independent accumulators let the compiler keep
+// several partial sums in vector registers instead of one serial chain.
+constexpr size_t FIGURE_KERNEL_LANES = 8;
+
+template<ScalarType T>
+double sumOfProducts(const T *a, const T *b, size_t n){
+    double acc[FIGURE_KERNEL_LANES] = {};
+    size_t i = 0;
+    for (; i + FIGURE_KERNEL_LANES <= n; i += FIGURE_KERNEL_LANES){
+        for (size_t j = 0; j < FIGURE_KERNEL_LANES; ++j){
+            acc[j] += static_cast<double>(a[i + j] * b[i + j]);
+        }
+    }
+    double total = 0.0;
+    for (size_t j = 0; j < FIGURE_KERNEL_LANES; ++j){
+        total += acc[j];
+    }
+    for (; i < n; ++i){
+        total += static_cast<double>(a[i] * b[i]);
+    }
+    return total;
+}
+
+template<ScalarType T>
+double sumOfSquares(const T *a, size_t n){
+    double acc[FIGURE_KERNEL_LANES] = {};
+    size_t i = 0;
+    for (; i + FIGURE_KERNEL_LANES <= n; i += FIGURE_KERNEL_LANES){
+        for (size_t j = 0; j < FIGURE_KERNEL_LANES; ++j){
+            double value = static_cast<double>(a[i + j]);
+            acc[j] += value * value;
+        }
+    }
+    double total = 0.0;
+    for (size_t j = 0; j < FIGURE_KERNEL_LANES; ++j){
+        total += acc[j];
+    }
+    for (; i < n; ++i){
+        double value = static_cast<double>(a[i]);
+        total += value * value;
+    }
+    return total;
+}
+
+// Columnar (structure-of-arrays) storage: one contiguous column per field
+// and per shape kind, so aggregate kernels stream over plain arrays.
+template<ScalarType T>
+class FigureStore{
+public:
+    struct RhombusColumns{
+        Array<T> diagonal1;
+        Array<T> diagonal2;
+        Array<T> x;
+        Array<T> y;
+    };
+    struct PolygonColumns{
+        Array<T> side;
+        Array<T> x;
+        Array<T> y;
+    };
+
+private:
+    RhombusColumns rhombuses_;
+    PolygonColumns pentagons_;
+    PolygonColumns hexagons_;
+
+    template<size_t N>
+    static double *writePolygonBoxes(const PolygonColumns &columns, double *out){
+        const T *side = columns.side.begin();
+        const T *x = columns.x.begin();
+        const T *y = columns.y.begin();
+        size_t n = columns.x.size();
+        for (size_t i = 0; i < n; ++i, out += BOUNDING_BOX_STRIDE){
+            writeBox(RegularPolygon<N, T>::boundingBoxOf(side[i], x[i], y[i]), out);
+        }
+        return out;
+    }
+    static void writeBox(const BoundingBox &box, double *out){
+        out[0] = box.minX;
+        out[1] = box.minY;
+        out[2] = box.maxX;
+        out[3] = box.maxY;
+    }
+    // Column kernels for the transforms: plain loops over contiguous
+    // arrays that the compiler can vectorize.
+    static void translateColumns(Array<T> &xs, Array<T> &ys, T dx, T dy){
+        T *x = xs.begin();
+        T *y = ys.begin();
+        for (size_t i = 0; i < xs.size(); ++i){
+            x[i] += dx;
+            y[i] += dy;
+        }
+    }
+    static void scaleColumn(Array<T> &values, T factor){
+        T *value = values.begin();
+        for (size_t i = 0; i < values.size(); ++i){
+            value[i] *= factor;
+        }
+    }
+    static void scaleColumns(Array<T> &xs, Array<T> &ys, T factor, T pivot_x, T pivot_y){
+        T *x = xs.begin();
+        T *y = ys.begin();
+        for (size_t i = 0; i < xs.size(); ++i){
+            x[i] = pivot_x + factor * (x[i] - pivot_x);
+            y[i] = pivot_y + factor * (y[i] - pivot_y);
+        }
+    }
+    static void rotateColumns(Array<T> &xs, Array<T> &ys, int turns, T pivot_x, T pivot_y){
+        T *x = xs.begin();
+        T *y = ys.begin();
+        size_t n = xs.size();
+        if (turns == 1){
+            for (size_t i = 0; i < n; ++i){
+                T dx = x[i] - pivot_x, dy = y[i] - pivot_y;
+                x[i] = pivot_x - dy;
+                y[i] = pivot_y + dx;
+            }
+        } else if (turns == 2){
+            for (size_t i = 0; i < n; ++i){
+                x[i] = pivot_x - (x[i] - pivot_x);
+                y[i] = pivot_y - (y[i] - pivot_y);
+            }
+        } else if (turns == 3){
+            for (size_t i = 0; i < n; ++i){
+                T dx = x[i] - pivot_x, dy = y[i] - pivot_y;
+                x[i] = pivot_x + dy;
+                y[i] = pivot_y - dx;
+            }
+        }
+    }
+    static void append(PolygonColumns &columns, T side, T x, T y){
+        columns.side.push_back(side);
+        columns.x.push_back(x);
+        columns.y.push_back(y);
+    }
+
+public:
+    FigureStore() = default;
+    explicit FigureStore(const Array<std::shared_ptr<Figure<T>>> &figures){
+        for (size_t i = 0; i < figures.size(); ++i){
+            add(*figures[i]);
+        }
+    }
+    void addRhombus(T d1, T d2, T x, T y){
+        rhombuses_.diagonal1.push_back(d1);
+        rhombuses_.diagonal2.push_back(d2);
+        rhombuses_.x.push_back(x);
+        rhombuses_.y.push_back(y);
+    }
+    void addPentagon(T side, T x, T y){
+        append(pentagons_, side, x, y);
+    }
+    void addHexagon(T side, T x, T y){
+        append(hexagons_, side, x, y);
+    }
+    void add(const Figure<T> &figure){
+        if (auto rhombus = dynamic_cast<const Rhombus<T>*>(&figure)){
+            Point<T> center = rhombus->getCenter();
+            addRhombus(rhombus->getDiagonal1(), rhombus->getDiagonal2(), center.x(), center.y());
+        } else if (auto pentagon = dynamic_cast<const Pentagon<T>*>(&figure)){
+            Point<T> center = pentagon->getCenter();
+            addPentagon(pentagon->getSide(), center.x(), center.y());
+        } else if (auto hexagon = dynamic_cast<const Hexagon<T>*>(&figure)){
+            Point<T> center = hexagon->getCenter();
+            addHexagon(hexagon->getSide(), center.x(), center.y());
+        } else {
+            throw std::invalid_argument("FigureStore: unsupported figure type");
+        }
+    }
+    void translate(T dx, T dy){
+        translateColumns(rhombuses_.x, rhombuses_.y, dx, dy);
+        translateColumns(pentagons_.x, pentagons_.y, dx, dy);
+        translateColumns(hexagons_.x, hexagons_.y, dx, dy);
+    }
+    void scale(T factor, T pivot_x, T pivot_y){
+        checkScaleFactor(factor);
+        scaleColumn(rhombuses_.diagonal1, factor);
+        scaleColumn(rhombuses_.diagonal2, factor);
+        scaleColumn(pentagons_.side, factor);
+        scaleColumn(hexagons_.side, factor);
+        scaleColumns(rhombuses_.x, rhombuses_.y, factor, pivot_x, pivot_y);
+        scaleColumns(pentagons_.x, pentagons_.y, factor, pivot_x, pivot_y);
+        scaleColumns(hexagons_.x, hexagons_.y, factor, pivot_x, pivot_y);
+    }
+    // Same rules as Figure::rotateQuarterTurns; all or nothing.
+    bool canRotateQuarterTurns(int quarters) const{
+        int turns = normalizedQuarterTurns(quarters);
+        return (pentagonCount() == 0 || turns * 5 % 4 == 0) && (hexagonCount() == 0 || turns * 6 % 4 == 0);
+    }
+    bool rotateQuarterTurns(int quarters, T pivot_x, T pivot_y){
+        if (!canRotateQuarterTurns(quarters)){
+            return false;
+        }
+        int turns = normalizedQuarterTurns(quarters);
+        if (turns % 2 == 1){
+            std::swap(rhombuses_.diagonal1, rhombuses_.diagonal2);
+        }
+        rotateColumns(rhombuses_.x, rhombuses_.y, turns, pivot_x, pivot_y);
+        rotateColumns(pentagons_.x, pentagons_.y, turns, pivot_x, pivot_y);
+        rotateColumns(hexagons_.x, hexagons_.y, turns, pivot_x, pivot_y);
+        return true;
+    }
+    void clear(){
+        rhombuses_ = RhombusColumns();
+        pentagons_ = PolygonColumns();
+        hexagons_ = PolygonColumns();
+    }
+
+    const RhombusColumns &rhombuses() const {return rhombuses_;}
+    const PolygonColumns &pentagons() const {return pentagons_;}
+    const PolygonColumns &hexagons() const {return hexagons_;}
+    size_t rhombusCount() const {return rhombuses_.x.size();}
+    size_t pentagonCount() const {return pentagons_.x.size();}
+    size_t hexagonCount() const {return hexagons_.x.size();}
+    size_t size() const {return rhombusCount() + pentagonCount() + hexagonCount();}
+    bool empty() const {return size() == 0;}
+
+    double rhombusArea() const{
+        return sumOfProducts(rhombuses_.diagonal1.begin(), rhombuses_.diagonal2.begin(), rhombusCount()) / 2.0;
+    }
+    double pentagonArea() const{
+        return RegularPolygonTable<5>::AREA_COEFFICIENT * sumOfSquares(pentagons_.side.begin(), pentagonCount());
+    }
+    double hexagonArea() const{
+        return RegularPolygonTable<6>::AREA_COEFFICIENT * sumOfSquares(hexagons_.side.begin(), hexagonCount());
+    }
+    double totalArea() const{
+        return rhombusArea() + pentagonArea() + hexagonArea();
+    }
+    // Fills out with size() records of BOUNDING_BOX_STRIDE doubles: all
+    // rhombuses first, then pentagons, then hexagons.
+    void writeBoundingBoxes(double *out) const{
+        const T *d1 = rhombuses_.diagonal1.begin();
+        const T *d2 = rhombuses_.diagonal2.begin();
+        const T *x = rhombuses_.x.begin();
+        const T *y = rhombuses_.y.begin();
+        for (size_t i = 0; i < rhombusCount(); ++i, out += BOUNDING_BOX_STRIDE){
+            writeBox(Rhombus<T>::boundingBoxOf(d1[i], d2[i], x[i], y[i]), out);
+        }
+        out = writePolygonBoxes<5>(pentagons_, out);
+        writePolygonBoxes<6>(hexagons_, out);
+    }
+};
+
+template<ScalarType T>
+double calculateTotalArea(const FigureStore<T> &store){
+    return store.totalArea();
+}
+#endif
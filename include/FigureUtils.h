@@ -3,14 +3,383 @@
 
 #include "Figure.h"
 #include "Array.h"
+#include "SmallArray.h"
+#include "CowArray.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
+#include <stdexcept>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 template<ScalarType T>
-double calculateTotalArea(const Array<std::shared_ptr<Figure<T>>> &figures){
+double sumAreas(const std::shared_ptr<Figure<T>> *first, const std::shared_ptr<Figure<T>> *last){
     double total = 0.0;
-    for (size_t i = 0; i < figures.size(); ++i){
-        total += figures[i]->calculateArea();
+    for (; first != last; ++first){
+        total += (*first)->calculateArea();
     }
     return total;
 }
-#endif
\ No newline at end of file
+
+template<ScalarType T, typename Alloc>
+double calculateTotalArea(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures){
+    return sumAreas(figures.begin(), figures.end());
+}
+
+template<ScalarType T, size_t N>
+double calculateTotalArea(const SmallArray<std::shared_ptr<Figure<T>>, N> &figures){
+    return sumAreas(figures.begin(), figures.end());
+}
+
+template<ScalarType T, typename Alloc>
+double calculateTotalArea(const CowArray<std::shared_ptr<Figure<T>>, Alloc> &figures){
+    return sumAreas(figures.begin(), figures.end());
+}
+
+// Pairwise (cascade) summation: rounding error grows with log(n) rather
+// than n, and the grouping depends only on the input length.
+template<typename Value>
+double pairwiseSum(const Value *values, size_t n){
+    if (n <= 16){
+        double total = 0.0;
+        for (size_t i = 0; i < n; ++i){
+            total += values[i];
+        }
+        return total;
+    }
+    size_t half = n / 2;
+    return pairwiseSum(values, half) + pairwiseSum(values + half, n - half);
+}
+
+template<ScalarType T>
+double pairwiseAreaSum(const std::shared_ptr<Figure<T>> *figures, size_t n){
+    if (n <= 16){
+        double total = 0.0;
+        for (size_t i = 0; i < n; ++i){
+            total += figures[i]->calculateArea();
+        }
+        return total;
+    }
+    size_t half = n / 2;
+    return pairwiseAreaSum(figures, half) + pairwiseAreaSum(figures + half, n - half);
+}
+
+// Blocks have a fixed size, so the partition and every rounding step are the
+// same for any thread count: the result is bit-identical from 1 to N threads.
+constexpr size_t AREA_BLOCK_SIZE = 4096;
+
+template<ScalarType T, typename Alloc>
+double calculateTotalAreaParallel(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures, unsigned threads = defaultThreadCount()){
+    size_t blocks = (figures.size() + AREA_BLOCK_SIZE - 1) / AREA_BLOCK_SIZE;
+    std::vector<double> partial(blocks);
+    const std::shared_ptr<Figure<T>> *data = figures.begin();
+    parallelFor(blocks, threads, [&](size_t begin, size_t end){
+        for (size_t block = begin; block < end; ++block){
+            size_t first = block * AREA_BLOCK_SIZE;
+            size_t count = std::min(AREA_BLOCK_SIZE, figures.size() - first);
+            partial[block] = pairwiseAreaSum(data + first, count);
+        }
+    });
+    return pairwiseSum(partial.data(), blocks);
+}
+
+// Fills out with figures.size() records of BOUNDING_BOX_STRIDE doubles.
+template<ScalarType T, typename Alloc>
+void writeBoundingBoxes(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures, double *out){
+    for (size_t i = 0; i < figures.size(); ++i, out += BOUNDING_BOX_STRIDE){
+        BoundingBox box = figures[i]->boundingBox();
+        out[0] = box.minX;
+        out[1] = box.minY;
+        out[2] = box.maxX;
+        out[3] = box.maxY;
+    }
+}
+
+// Ranking helpers compute each key once into a compact (key, index) array
+// and sort or select on that instead of calling virtuals from a comparator.
+// Ties are broken by index, so results do not depend on the thread count;
+// a NaN key ranks as +infinity.
+struct FigureKey{
+    double key;
+    size_t index;
+};
+
+inline bool figureKeyLess(const FigureKey &a, const FigureKey &b){
+    return a.key < b.key || (a.key == b.key && a.index < b.index);
+}
+inline bool figureKeyGreater(const FigureKey &a, const FigureKey &b){
+    return a.key > b.key || (a.key == b.key && a.index < b.index);
+}
+
+inline FigureKey makeFigureKey(double key, size_t index){
+    return {std::isnan(key) ? std::numeric_limits<double>::infinity() : key, index};
+}
+
+template<ScalarType T, typename Alloc, typename KeyOf>
+std::vector<FigureKey> extractFigureKeys(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures, KeyOf keyOf, unsigned threads){
+    std::vector<FigureKey> keys(figures.size());
+    const std::shared_ptr<Figure<T>> *data = figures.begin();
+    size_t blocks = (figures.size() + AREA_BLOCK_SIZE - 1) / AREA_BLOCK_SIZE;
+    parallelFor(blocks, threads, [&](size_t begin, size_t end){
+        for (size_t i = begin * AREA_BLOCK_SIZE; i < std::min(end * AREA_BLOCK_SIZE, figures.size()); ++i){
+            keys[i] = makeFigureKey(keyOf(*data[i]), i);
+        }
+    });
+    return keys;
+}
+
+struct AreaKey{
+    template<ScalarType T>
+    double operator()(const Figure<T> &figure) const{
+        return figure.calculateArea();
+    }
+};
+
+// Squared distance from (x, y) to the figure's center.
+struct CenterDistanceKey{
+    double x;
+    double y;
+
+    template<ScalarType T>
+    double operator()(const Figure<T> &figure) const{
+        Point<T> center = figure.calculateCenter();
+        double dx = static_cast<double>(center.x()) - x;
+        double dy = static_cast<double>(center.y()) - y;
+        return dx * dx + dy * dy;
+    }
+};
+
+// The first k keys in less order, themselves sorted: O(n + k log k).
+template<typename Compare>
+Array<size_t> selectKeys(std::vector<FigureKey> &keys, size_t k, Compare less){
+    k = std::min(k, keys.size());
+    if (k < keys.size()){
+        std::nth_element(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(k), keys.end(), less);
+    }
+    std::sort(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(k), less);
+    Array<size_t> indices;
+    indices.reserve(k);
+    for (size_t i = 0; i < k; ++i){
+        indices.push_back(keys[i].index);
+    }
+    return indices;
+}
+
+// Top k without materializing every key when k is small: each thread keeps
+// a bounded heap whose front is the worst key kept, and the survivors are
+// merged at the end.
+template<ScalarType T, typename Alloc, typename KeyOf, typename Compare>
+Array<size_t> selectFigures(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures, size_t k, KeyOf keyOf, Compare less, unsigned threads){
+    if (k == 0){
+        return Array<size_t>();
+    }
+    if (k > figures.size() / 16){
+        auto keys = extractFigureKeys(figures, keyOf, threads);
+        return selectKeys(keys, k, less);
+    }
+    const std::shared_ptr<Figure<T>> *data = figures.begin();
+    size_t blocks = (figures.size() + AREA_BLOCK_SIZE - 1) / AREA_BLOCK_SIZE;
+    std::vector<std::vector<FigureKey>> heaps(blocks);
+    parallelFor(blocks, threads, [&](size_t begin, size_t end){
+        std::vector<FigureKey> &heap = heaps[begin];
+        heap.reserve(k);
+        for (size_t i = begin * AREA_BLOCK_SIZE; i < std::min(end * AREA_BLOCK_SIZE, figures.size()); ++i){
+            FigureKey key = makeFigureKey(keyOf(*data[i]), i);
+            if (heap.size() < k){
+                heap.push_back(key);
+                std::push_heap(heap.begin(), heap.end(), less);
+            } else if (less(key, heap.front())){
+                std::pop_heap(heap.begin(), heap.end(), less);
+                heap.back() = key;
+                std::push_heap(heap.begin(), heap.end(), less);
+            }
+        }
+    });
+    std::vector<FigureKey> survivors;
+    for (const auto &heap : heaps){
+        survivors.insert(survivors.end(), heap.begin(), heap.end());
+    }
+    return selectKeys(survivors, k, less);
+}
+
+inline Array<size_t> sortKeys(std::vector<FigureKey> &keys, unsigned threads){
+    parallelSort(keys.data(), keys.size(), threads, figureKeyLess);
+    Array<size_t> indices;
+    indices.reserve(keys.size());
+    for (const FigureKey &key : keys){
+        indices.push_back(key.index);
+    }
+    return indices;
+}
+
+// Indices of all figures, smallest area first.
+template<ScalarType T, typename Alloc>
+Array<size_t> sortedByArea(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures, unsigned threads = defaultThreadCount()){
+    auto keys = extractFigureKeys(figures, AreaKey{}, threads);
+    return sortKeys(keys, threads);
+}
+
+// Indices of all figures, nearest center to (x, y) first.
+template<ScalarType T, typename Alloc>
+Array<size_t> sortedByCenterDistance(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures, double x, double y, unsigned threads = defaultThreadCount()){
+    auto keys = extractFigureKeys(figures, CenterDistanceKey{x, y}, threads);
+    return sortKeys(keys, threads);
+}
+
+// Indices of the k largest figures, largest first.
+template<ScalarType T, typename Alloc>
+Array<size_t> largestByArea(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures, size_t k, unsigned threads = defaultThreadCount()){
+    return selectFigures(figures, k, AreaKey{}, figureKeyGreater, threads);
+}
+
+// Indices of the k figures whose centers are nearest to (x, y), nearest first.
+template<ScalarType T, typename Alloc>
+Array<size_t> nearestByCenter(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures, double x, double y, size_t k, unsigned threads = defaultThreadCount()){
+    return selectFigures(figures, k, CenterDistanceKey{x, y}, figureKeyLess, threads);
+}
+
+// Index of the figure that sortedByArea would put at position n.
+template<ScalarType T, typename Alloc>
+size_t nthByArea(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures, size_t n, unsigned threads = defaultThreadCount()){
+    if (n >= figures.size()){
+        throw std::out_of_range("nthByArea: position out of bounds");
+    }
+    auto keys = extractFigureKeys(figures, AreaKey{}, threads);
+    std::nth_element(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(n), keys.end(), figureKeyLess);
+    return keys[n].index;
+}
+
+// Materializes a view produced by the functions above.
+template<ScalarType T, typename Alloc>
+Array<std::shared_ptr<Figure<T>>, Alloc> gatherFigures(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures, const Array<size_t> &indices){
+    Array<std::shared_ptr<Figure<T>>, Alloc> result(figures.get_allocator());
+    result.reserve(indices.size());
+    for (size_t index : indices){
+        result.push_back(figures[index]);
+    }
+    return result;
+}
+
+// Lets hash containers hold figure indices: hashes are computed once up
+// front and equality is isEqual, so lookups cost no extra virtual hashing.
+struct FigureIndexHash{
+    const size_t *hashes;
+
+    size_t operator()(size_t index) const{
+        return hashes[index];
+    }
+};
+
+template<ScalarType T>
+struct FigureIndexEqual{
+    const std::shared_ptr<Figure<T>> *figures;
+
+    bool operator()(size_t a, size_t b) const{
+        return a == b || figures[a]->isEqual(*figures[b]);
+    }
+};
+
+template<ScalarType T, typename Alloc>
+std::vector<size_t> figureHashes(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures){
+    std::vector<size_t> hashes(figures.size());
+    for (size_t i = 0; i < figures.size(); ++i){
+        hashes[i] = figures[i]->hashValue();
+    }
+    return hashes;
+}
+
+// Indices of equal figures (by isEqual), one group per distinct figure in
+// order of first appearance. Expected O(n).
+template<ScalarType T, typename Alloc>
+Array<Array<size_t>> groupByParameters(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures){
+    std::vector<size_t> hashes = figureHashes(figures);
+    std::unordered_map<size_t, size_t, FigureIndexHash, FigureIndexEqual<T>> group_of(
+        figures.size(), FigureIndexHash{hashes.data()}, FigureIndexEqual<T>{figures.begin()});
+    Array<Array<size_t>> groups;
+    for (size_t i = 0; i < figures.size(); ++i){
+        auto [it, inserted] = group_of.try_emplace(i, groups.size());
+        if (inserted){
+            groups.emplace_back();
+        }
+        groups[it->second].push_back(i);
+    }
+    return groups;
+}
+
+// Indices grouped by dynamic type, in order of first appearance.
+template<ScalarType T, typename Alloc>
+Array<Array<size_t>> groupByKind(const Array<std::shared_ptr<Figure<T>>, Alloc> &figures){
+    std::unordered_map<std::type_index, size_t> group_of;
+    Array<Array<size_t>> groups;
+    for (size_t i = 0; i < figures.size(); ++i){
+        auto [it, inserted] = group_of.try_emplace(std::type_index(typeid(*figures[i])), groups.size());
+        if (inserted){
+            groups.emplace_back();
+        }
+        groups[it->second].push_back(i);
+    }
+    return groups;
+}
+
+// Keeps the first of every set of equal figures; returns how many were
+// removed. Expected O(n).
+template<ScalarType T, typename Alloc>
+size_t removeDuplicateFigures(Array<std::shared_ptr<Figure<T>>, Alloc> &figures){
+    std::vector<size_t> hashes = figureHashes(figures);
+    std::vector<bool> duplicate(figures.size());
+    {
+        std::unordered_set<size_t, FigureIndexHash, FigureIndexEqual<T>> seen(
+            figures.size(), FigureIndexHash{hashes.data()}, FigureIndexEqual<T>{figures.begin()});
+        for (size_t i = 0; i < figures.size(); ++i){
+            duplicate[i] = !seen.insert(i).second;
+        }
+    }
+    size_t index = 0;
+    return figures.erase_if([&duplicate, &index](const std::shared_ptr<Figure<T>> &){
+        return duplicate[index++];
+    });
+}
+
+// Transforms applied to every figure of a collection. For columnar data
+// FigureStore has the same operations without per-figure virtual calls.
+template<ScalarType T, typename Alloc>
+void translateFigures(Array<std::shared_ptr<Figure<T>>, Alloc> &figures, T dx, T dy){
+    for (auto &figure : figures){
+        figure->translate(dx, dy);
+    }
+}
+
+template<ScalarType T, typename Alloc>
+void scaleFigures(Array<std::shared_ptr<Figure<T>>, Alloc> &figures, T factor, T pivot_x, T pivot_y){
+    for (auto &figure : figures){
+        figure->scale(factor, pivot_x, pivot_y);
+    }
+}
+
+// All or nothing: returns false without touching any figure if one of them
+// cannot take the turn.
+template<ScalarType T, typename Alloc>
+bool rotateFiguresQuarterTurns(Array<std::shared_ptr<Figure<T>>, Alloc> &figures, int quarters, T pivot_x, T pivot_y){
+    for (const auto &figure : std::as_const(figures)){
+        if (!figure->canRotateQuarterTurns(quarters)){
+            return false;
+        }
+    }
+    for (auto &figure : figures){
+        figure->rotateQuarterTurns(quarters, pivot_x, pivot_y);
+    }
+    return true;
+}
+
+template<ScalarType T, typename Alloc>
+size_t removeFiguresBelowArea(Array<std::shared_ptr<Figure<T>>, Alloc> &figures, double min_area){
+    return figures.erase_if([min_area](const std::shared_ptr<Figure<T>> &figure){
+        return figure->calculateArea() < min_area;
+    });
+}
+#endif
@@ -0,0 +1,97 @@
+#ifndef FIGUREVARIANT_H
+#define FIGUREVARIANT_H
+
+#include "Figure.h"
+#include "Rhombus.h"
+#include "Pentagon.h"
+#include "Hexagon.h"
+#include "Array.h"
+#include <variant>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+// Closed set of shapes stored inline. The alternative held by the variant is
+// the exact dynamic type, so the visitors below use qualified calls and the
+// compiler can inline them instead of going through the vtable.
+template<ScalarType T>
+using FigureVariant = std::variant<Rhombus<T>, Pentagon<T>, Hexagon<T>>;
+
+template<ScalarType T>
+double figureArea(const FigureVariant<T> &figure){
+    return std::visit([](const auto &shape){
+        using Shape = std::decay_t<decltype(shape)>;
+        return shape.Shape::calculateArea();
+    }, figure);
+}
+
+template<ScalarType T>
+Point<T> figureCenter(const FigureVariant<T> &figure){
+    return std::visit([](const auto &shape){
+        using Shape = std::decay_t<decltype(shape)>;
+        return shape.Shape::calculateCenter();
+    }, figure);
+}
+
+template<ScalarType T>
+size_t figureVertices(const FigureVariant<T> &figure, Point<T> *out){
+    return std::visit([out](const auto &shape){
+        using Shape = std::decay_t<decltype(shape)>;
+        return shape.Shape::writeVertices(out);
+    }, figure);
+}
+
+template<ScalarType T>
+bool figuresEqual(const FigureVariant<T> &lhs, const FigureVariant<T> &rhs){
+    return lhs == rhs;
+}
+
+template<ScalarType T>
+double calculateTotalArea(const Array<FigureVariant<T>> &figures){
+    double total = 0.0;
+    for (size_t i = 0; i < figures.size(); ++i){
+        total += figureArea(figures[i]);
+    }
+    return total;
+}
+
+template<ScalarType T>
+FigureVariant<T> toFigureVariant(const Figure<T> &figure){
+    if (auto rhombus = dynamic_cast<const Rhombus<T>*>(&figure)){
+        return *rhombus;
+    }
+    if (auto pentagon = dynamic_cast<const Pentagon<T>*>(&figure)){
+        return *pentagon;
+    }
+    if (auto hexagon = dynamic_cast<const Hexagon<T>*>(&figure)){
+        return *hexagon;
+    }
+    throw std::invalid_argument("FigureVariant: unsupported figure type");
+}
+
+template<ScalarType T>
+std::shared_ptr<Figure<T>> toFigurePtr(const FigureVariant<T> &figure){
+    return std::visit([](const auto &shape) -> std::shared_ptr<Figure<T>>{
+        using Shape = std::decay_t<decltype(shape)>;
+        return std::make_shared<Shape>(shape);
+    }, figure);
+}
+
+template<ScalarType T>
+Array<FigureVariant<T>> toVariantArray(const Array<std::shared_ptr<Figure<T>>> &figures){
+    Array<FigureVariant<T>> result(figures.size());
+    for (size_t i = 0; i < figures.size(); ++i){
+        result[i] = toFigureVariant(*figures[i]);
+    }
+    return result;
+}
+
+template<ScalarType T>
+Array<std::shared_ptr<Figure<T>>> toFigureArray(const Array<FigureVariant<T>> &figures){
+    Array<std::shared_ptr<Figure<T>>> result(figures.size());
+    for (size_t i = 0; i < figures.size(); ++i){
+        result[i] = toFigurePtr(figures[i]);
+    }
+    return result;
+}
+#endif
@@ -0,0 +1,23 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+inline size_t hashCombine(size_t seed, size_t value){
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+// Values that compare equal hash equally: -0.0 and 0.0 share one hash.
+template<typename T>
+size_t hashScalar(T value){
+    if constexpr (std::is_floating_point_v<T>){
+        if (value == T(0)){
+            value = T(0);
+        }
+    }
+    return std::hash<T>()(value);
+}
+
+#endif
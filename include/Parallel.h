@@ -0,0 +1,94 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+inline unsigned defaultThreadCount(){
+    unsigned count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+// Splits [0, count) into one contiguous range per thread and calls
+// body(begin, end) for each; the calling thread takes the first range.
+// The first exception thrown by any range is rethrown after all joins.
+template<typename Body>
+void parallelFor(size_t count, unsigned threads, Body body){
+    size_t workers = std::min<size_t>(std::max(threads, 1u), count);
+    if (workers <= 1){
+        if (count > 0){
+            body(size_t(0), count);
+        }
+        return;
+    }
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto run = [&](size_t begin, size_t end){
+        try{
+            body(begin, end);
+        } catch (...){
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error){
+                error = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    size_t chunk = count / workers;
+    size_t extra = count % workers;
+    size_t begin = chunk + (extra > 0 ? 1 : 0);
+    for (size_t w = 1; w < workers; ++w){
+        size_t end = begin + chunk + (w < extra ? 1 : 0);
+        pool.emplace_back(run, begin, end);
+        begin = end;
+    }
+    run(0, chunk + (extra > 0 ? 1 : 0));
+    for (auto &thread : pool){
+        thread.join();
+    }
+    if (error){
+        std::rethrow_exception(error);
+    }
+}
+
+// Sorts [data, data + n) by sorting one run per thread and then merging
+// neighbouring runs pairwise, each merge round in parallel. Small inputs and
+// a single thread fall back to std::sort.
+constexpr size_t PARALLEL_SORT_THRESHOLD = 1 << 15;
+
+template<typename Value, typename Compare>
+void parallelSort(Value *data, size_t n, unsigned threads, Compare less){
+    size_t runs = std::min<size_t>(std::max(threads, 1u), n / (PARALLEL_SORT_THRESHOLD / 2));
+    if (n < PARALLEL_SORT_THRESHOLD || runs <= 1){
+        std::sort(data, data + n, less);
+        return;
+    }
+    std::vector<size_t> bounds(runs + 1);
+    for (size_t i = 0; i <= runs; ++i){
+        bounds[i] = n * i / runs;
+    }
+    parallelFor(runs, threads, [&](size_t begin, size_t end){
+        for (size_t run = begin; run < end; ++run){
+            std::sort(data + bounds[run], data + bounds[run + 1], less);
+        }
+    });
+    for (size_t width = 1; width < runs; width *= 2){
+        size_t pairs = (runs + 2 * width - 1) / (2 * width);
+        parallelFor(pairs, threads, [&](size_t begin, size_t end){
+            for (size_t pair = begin; pair < end; ++pair){
+                size_t first = pair * 2 * width;
+                size_t middle = std::min(first + width, runs);
+                size_t last = std::min(first + 2 * width, runs);
+                if (middle < last){
+                    std::inplace_merge(data + bounds[first], data + bounds[middle], data + bounds[last], less);
+                }
+            }
+        });
+    }
+}
+
+#endif
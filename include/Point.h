@@ -4,10 +4,30 @@
 #include <type_traits>
 #include <memory>
 #include <iostream>
+#include "Hash.h"
+#include "Relocation.h"
 
 template<typename T>
 concept ScalarType = std::is_scalar_v<T>;
 
+// Quarter turns are exact: they only swap and negate offsets.
+inline int normalizedQuarterTurns(int quarters){
+    return ((quarters % 4) + 4) % 4;
+}
+
+// Rotates (x, y) counterclockwise by quarters * 90 degrees about the pivot.
+template<typename T>
+void rotateQuarterTurnsAbout(T &x, T &y, int quarters, T pivot_x, T pivot_y){
+    T dx = x - pivot_x;
+    T dy = y - pivot_y;
+    switch (normalizedQuarterTurns(quarters)){
+        case 1: x = pivot_x - dy; y = pivot_y + dx; break;
+        case 2: x = pivot_x - dx; y = pivot_y - dy; break;
+        case 3: x = pivot_x + dy; y = pivot_y - dx; break;
+        default: break;
+    }
+}
+
 template<ScalarType T>
 class Point{
 private:
@@ -18,28 +38,12 @@ public:
     Point() : x_(0), y_(0) {}
     Point(T x, T y) : x_(x), y_(y) {}
 
-    Point(const Point &other) : x_(other.x_), y_(other.y_) {}
-    Point(Point &&other) noexcept : x_(std::move(other.x_)), y_(std::move(other.y_)){
-        other.x_ = T(0);
-        other.y_ = T(0);
-    }
-
-    Point &operator=(const Point &other){
-        if (this != &other){
-            x_ = other.x_;
-            y_ = other.y_;
-        }
-        return *this;
-    }
-    Point &operator=(Point &&other) noexcept{
-        if (this != &other){
-            x_ = std::move(other.x_);
-            y_ = std::move(other.y_);
-            other.x_ = T(0);
-            other.y_ = T(0);
-        }
-        return *this;
-    }
+    // Copying and moving are plain member copies, so Point is trivially
+    // copyable and arrays of points grow and shift with memcpy.
+    Point(const Point &other) = default;
+    Point(Point &&other) noexcept = default;
+    Point &operator=(const Point &other) = default;
+    Point &operator=(Point &&other) noexcept = default;
     T x() const{
         return x_;
     }
@@ -53,6 +57,18 @@ public:
         y_ = y;
     }
 
+    void translate(T dx, T dy){
+        x_ += dx;
+        y_ += dy;
+    }
+    void scaleAbout(T factor, T pivot_x, T pivot_y){
+        x_ = pivot_x + factor * (x_ - pivot_x);
+        y_ = pivot_y + factor * (y_ - pivot_y);
+    }
+    void rotateQuarterTurns(int quarters, T pivot_x, T pivot_y){
+        rotateQuarterTurnsAbout(x_, y_, quarters, pivot_x, pivot_y);
+    }
+
     bool operator==(const Point &other) const{
         return x_ == other.x_ && y_ == other.y_;
     }
@@ -71,4 +87,11 @@ public:
 template<ScalarType T>
 using PointPtr = std::unique_ptr<Point<T>>;
 
+template<ScalarType T>
+struct std::hash<Point<T>>{
+    size_t operator()(const Point<T> &point) const{
+        return hashCombine(hashScalar(point.x()), hashScalar(point.y()));
+    }
+};
+
 #endif
\ No newline at end of file
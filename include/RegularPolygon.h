@@ -0,0 +1,236 @@
+#ifndef REGULARPOLYGON_H
+#define REGULARPOLYGON_H
+
+#include "Figure.h"
+#include <algorithm>
+#include <memory>
+#include <array>
+#include <cmath>
+
+// Taylor series on [-pi/2, pi/2]; used only to build compile-time tables.
+constexpr double constexprSin(double x){
+    while (x > M_PI){
+        x -= 2.0 * M_PI;
+    }
+    while (x < -M_PI){
+        x += 2.0 * M_PI;
+    }
+    if (x > M_PI / 2.0){
+        x = M_PI - x;
+    } else if (x < -M_PI / 2.0){
+        x = -M_PI - x;
+    }
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 20; ++n){
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constexprCos(double x){
+    return constexprSin(M_PI / 2.0 - x);
+}
+
+// Per-N constants for a regular polygon with unit side: vertex offsets from
+// the center and the area coefficient (area = AREA_COEFFICIENT * side^2).
+// Odd polygons start with a vertex straight below the center, even ones
+// with a vertex on the positive x axis.
+template<size_t N>
+struct RegularPolygonTable{
+    static constexpr double START_ANGLE = (N % 2 == 1) ? -M_PI / 2.0 : 0.0;
+    static constexpr double CIRCUMRADIUS = 1.0 / (2.0 * constexprSin(M_PI / N));
+    static constexpr double AREA_COEFFICIENT = N * constexprCos(M_PI / N) / (4.0 * constexprSin(M_PI / N));
+
+    static constexpr std::array<double, N> makeOffsets(bool x_axis){
+        std::array<double, N> offsets{};
+        for (size_t i = 0; i < N; ++i){
+            double angle = 2.0 * M_PI * i / N + START_ANGLE;
+            offsets[i] = CIRCUMRADIUS * (x_axis ? constexprCos(angle) : constexprSin(angle));
+        }
+        return offsets;
+    }
+    static constexpr std::array<double, N> UNIT_X = makeOffsets(true);
+    static constexpr std::array<double, N> UNIT_Y = makeOffsets(false);
+
+    static constexpr double minOf(const std::array<double, N> &values){
+        double result = values[0];
+        for (double value : values){
+            result = value < result ? value : result;
+        }
+        return result;
+    }
+    static constexpr double maxOf(const std::array<double, N> &values){
+        double result = values[0];
+        for (double value : values){
+            result = value > result ? value : result;
+        }
+        return result;
+    }
+    // Bounding box of the unit-side polygon relative to its center.
+    static constexpr double UNIT_MIN_X = minOf(UNIT_X);
+    static constexpr double UNIT_MIN_Y = minOf(UNIT_Y);
+    static constexpr double UNIT_MAX_X = maxOf(UNIT_X);
+    static constexpr double UNIT_MAX_Y = maxOf(UNIT_Y);
+};
+
+template<size_t N>
+struct RegularPolygonTraits{
+    static constexpr const char *NAME = "regular_polygon";
+    static constexpr const char *LABEL = "Regular polygon vertices:";
+    static constexpr const char *PROMPT = "Enter regular polygon params (side, x, y)";
+};
+template<>
+struct RegularPolygonTraits<5>{
+    static constexpr const char *NAME = "pentagon";
+    static constexpr const char *LABEL = "Pentagons vertices:";
+    static constexpr const char *PROMPT = "Enter pentagon params (side, x, y)";
+};
+template<>
+struct RegularPolygonTraits<6>{
+    static constexpr const char *NAME = "hexagon";
+    static constexpr const char *LABEL = "Hetagon vertices:";
+    static constexpr const char *PROMPT = "Enter hexagon params (side, x, y)";
+};
+
+template<size_t N, ScalarType T>
+class RegularPolygon : public Figure<T>{
+    static_assert(N >= 3 && N <= Figure<T>::MAX_VERTICES, "unsupported vertex count");
+
+private:
+    using Table = RegularPolygonTable<N>;
+    using Traits = RegularPolygonTraits<N>;
+
+    T side_;
+    Point<T> center_;
+
+    static double asVertexCoordinate(double value){
+        return static_cast<double>(static_cast<T>(value));
+    }
+
+public:
+    static constexpr size_t VERTEX_COUNT = N;
+
+    RegularPolygon() : side_(0), center_(0, 0){}
+    RegularPolygon(T side, T x, T y) : side_(side), center_(x, y){}
+    RegularPolygon(T side, const Point<T> &center) : side_(side), center_(center){}
+    Point<T>  calculateCenter() const override{
+        return center_;
+    }
+    double calculateArea() const override{
+        return Table::AREA_COEFFICIENT * side_ * side_;
+    }
+    std::array<Point<T>, VERTEX_COUNT> vertices() const{
+        std::array<Point<T>, VERTEX_COUNT> result;
+        RegularPolygon::writeVertices(result.data());
+        return result;
+    }
+    size_t vertexCount() const override{
+        return VERTEX_COUNT;
+    }
+    size_t writeVertices(Point<T> *out) const override{
+        double side = static_cast<double>(side_);
+        double cx = static_cast<double>(center_.x());
+        double cy = static_cast<double>(center_.y());
+        for (size_t i = 0; i < VERTEX_COUNT; ++i){
+            out[i] = Point<T>(static_cast<T>(cx + side * Table::UNIT_X[i]),
+                              static_cast<T>(cy + side * Table::UNIT_Y[i]));
+        }
+        return VERTEX_COUNT;
+    }
+    BoundingBox boundingBox() const override{
+        return boundingBoxOf(side_, center_.x(), center_.y());
+    }
+    // Box of the vertices writeVertices produces. A negative side mirrors
+    // the polygon through its center, so the unit extremes swap ends. The
+    // conversion to T is monotonic, so converting the extremes the same way
+    // as the vertices (truncation for integers) keeps every vertex inside.
+    static BoundingBox boundingBoxOf(T side, T x, T y){
+        double s = static_cast<double>(side);
+        double cx = static_cast<double>(x);
+        double cy = static_cast<double>(y);
+        double x1 = cx + s * Table::UNIT_MIN_X;
+        double x2 = cx + s * Table::UNIT_MAX_X;
+        double y1 = cy + s * Table::UNIT_MIN_Y;
+        double y2 = cy + s * Table::UNIT_MAX_Y;
+        return BoundingBox{asVertexCoordinate(std::min(x1, x2)), asVertexCoordinate(std::min(y1, y2)),
+                           asVertexCoordinate(std::max(x1, x2)), asVertexCoordinate(std::max(y1, y2))};
+    }
+    std::vector<PointPtr<T>> getVertices() const override{
+        std::vector<PointPtr<T>> vertices;
+        vertices.reserve(VERTEX_COUNT);
+        for (const auto &vertex : this->vertices()){
+            vertices.push_back(std::make_unique<Point<T>>(vertex));
+        }
+        return vertices;
+    }
+    const char *kindName() const override{
+        return Traits::NAME;
+    }
+    const char *label() const override{
+        return Traits::LABEL;
+    }
+    void printVertices(std::ostream &os) const override{
+        os << Traits::LABEL << "\n";
+        for (const auto &vertex : vertices()){
+            os << vertex << "\n";
+        }
+    }
+    void read(std::istream &is) override{
+        std::cout << Traits::PROMPT;
+        is >> side_ >> center_;
+    }
+    bool isEqual(const Figure<T> &other) const override{
+        const RegularPolygon *polygon = dynamic_cast<const RegularPolygon*>(&other);
+        if (!polygon) return false;
+        return *this == *polygon;
+    }
+    size_t hashValue() const override{
+        size_t seed = hashCombine(N, hashScalar(side_));
+        return hashCombine(seed, std::hash<Point<T>>()(center_));
+    }
+    void translate(T dx, T dy) override{
+        center_.translate(dx, dy);
+    }
+    void scale(T factor, T pivot_x, T pivot_y) override{
+        checkScaleFactor(factor);
+        side_ *= factor;
+        center_.scaleAbout(factor, pivot_x, pivot_y);
+    }
+    // The turn must be a symmetry of the polygon: a multiple of 360 / N.
+    bool canRotateQuarterTurns(int quarters) const override{
+        return normalizedQuarterTurns(quarters) * N % 4 == 0;
+    }
+    bool rotateQuarterTurns(int quarters, T pivot_x, T pivot_y) override{
+        if (!canRotateQuarterTurns(quarters)){
+            return false;
+        }
+        center_.rotateQuarterTurns(quarters, pivot_x, pivot_y);
+        return true;
+    }
+    RegularPolygon(const RegularPolygon &other) = default;
+    RegularPolygon(RegularPolygon &&other) noexcept = default;
+    RegularPolygon &operator=(const RegularPolygon &other) = default;
+    RegularPolygon &operator=(RegularPolygon &&other) noexcept = default;
+    bool operator==(const RegularPolygon &other) const{
+        return side_ == other.side_ && center_ == other.center_;
+    }
+    T getSide() const {return side_;}
+    Point<T> getCenter() const {return center_;}
+};
+
+// Only the vtable pointer and plain fields: safe to move with memcpy.
+template<size_t N, ScalarType T>
+struct is_trivially_relocatable<RegularPolygon<N, T>> : std::true_type{};
+
+template<size_t N, ScalarType T>
+struct std::hash<RegularPolygon<N, T>>{
+    size_t operator()(const RegularPolygon<N, T> &polygon) const{
+        return polygon.hashValue();
+    }
+};
+
+template<ScalarType T>
+using Octagon = RegularPolygon<8, T>;
+#endif
@@ -0,0 +1,24 @@
+#ifndef RELOCATION_H
+#define RELOCATION_H
+
+#include <memory>
+#include <type_traits>
+
+// A type is trivially relocatable when moving an object to new storage and
+// ending the old one's lifetime can be done with a plain memcpy. Trivially
+// copyable types qualify automatically; others opt in by specialization.
+// Array relies on it for growth and for shifting elements on removal.
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T>{};
+
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Smart pointers only hold raw pointers to their owned state.
+template<typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type{};
+
+template<typename T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type{};
+
+#endif
@@ -4,6 +4,7 @@
 #include "Figure.h"
 #include <cmath>
 #include <memory>
+#include <array>
 
 template<ScalarType T>
 class Rhombus : public Figure<T>{
@@ -13,40 +14,68 @@ private:
     Point<T> center_;
 
 public:
+    static constexpr size_t VERTEX_COUNT = 4;
+
     Rhombus() : diagonal1_(0), diagonal2_(0), center_(0, 0){}
     Rhombus(T d1, T d2, T x, T y) : diagonal1_(d1), diagonal2_(d2), center_(x, y){}
     Rhombus(T d1, T d2, const Point<T> &center) : diagonal1_(d1), diagonal2_(d2), center_(center){}
-    Rhombus(const Rhombus &other) : diagonal1_(other.diagonal1_), diagonal2_(other.diagonal2_), center_(other.center_){}
-    Rhombus(Rhombus &&other) noexcept : diagonal1_(std::move(other.diagonal1_)), diagonal2_(std::move(other.diagonal2_)), center_(std::move(other.center_)){
-        other.diagonal1_ = T(0);
-        other.diagonal2_ = T(0);
-    }
+    Rhombus(const Rhombus &other) = default;
+    Rhombus(Rhombus &&other) noexcept = default;
     Point<T>  calculateCenter() const override{
         return center_;
     }
     double calculateArea() const override{
         return static_cast<double>(diagonal1_ * diagonal2_) / 2.0;
     }
-    std::vector<PointPtr<T>> getVertices() const override{
-        std::vector<PointPtr<T>> vertices;
-        vertices.reserve(4);
+    std::array<Point<T>, VERTEX_COUNT> vertices() const{
+        std::array<Point<T>, VERTEX_COUNT> result;
+        Rhombus::writeVertices(result.data());
+        return result;
+    }
+    size_t vertexCount() const override{
+        return VERTEX_COUNT;
+    }
+    size_t writeVertices(Point<T> *out) const override{
         T half_d1 = diagonal1_ / 2;
         T half_d2 = diagonal2_ / 2;
-        vertices.push_back(std::make_unique<Point<T>>(
-            center_.x(), center_.y() + half_d2));
-        vertices.push_back(std::make_unique<Point<T>>(
-            center_.x() + half_d1, center_.y()));
-        vertices.push_back(std::make_unique<Point<T>>(
-            center_.x(), center_.y() - half_d2));
-        vertices.push_back(std::make_unique<Point<T>>(
-            center_.x() - half_d1, center_.y()));
+        out[0] = Point<T>(center_.x(), center_.y() + half_d2);
+        out[1] = Point<T>(center_.x() + half_d1, center_.y());
+        out[2] = Point<T>(center_.x(), center_.y() - half_d2);
+        out[3] = Point<T>(center_.x() - half_d1, center_.y());
+        return VERTEX_COUNT;
+    }
+    BoundingBox boundingBox() const override{
+        return boundingBoxOf(diagonal1_, diagonal2_, center_.x(), center_.y());
+    }
+    // Box of the vertices writeVertices produces: the half diagonals are
+    // taken in T (truncated for integers) and a negative diagonal mirrors
+    // the rhombus onto the same box.
+    static BoundingBox boundingBoxOf(T d1, T d2, T x, T y){
+        T half_d1 = d1 / 2;
+        T half_d2 = d2 / 2;
+        half_d1 = half_d1 < 0 ? -half_d1 : half_d1;
+        half_d2 = half_d2 < 0 ? -half_d2 : half_d2;
+        return BoundingBox{static_cast<double>(x - half_d1), static_cast<double>(y - half_d2),
+                           static_cast<double>(x + half_d1), static_cast<double>(y + half_d2)};
+    }
+    std::vector<PointPtr<T>> getVertices() const override{
+        std::vector<PointPtr<T>> vertices;
+        vertices.reserve(VERTEX_COUNT);
+        for (const auto &vertex : this->vertices()){
+            vertices.push_back(std::make_unique<Point<T>>(vertex));
+        }
         return vertices;
     }
+    const char *kindName() const override{
+        return "rhombus";
+    }
+    const char *label() const override{
+        return "Rhombus vertices:";
+    }
     void printVertices(std::ostream &os) const override{
-        auto vertices = getVertices();
-        os << "Rhombus vertices:\n";
-        for (const auto &vertex : vertices){
-            os << *vertex << "\n";
+        os << label() << "\n";
+        for (const auto &vertex : vertices()){
+            os << vertex << "\n";
         }
     }
     void read(std::istream &is) override{
@@ -56,31 +85,50 @@ public:
     bool isEqual(const Figure<T> &other) const override{
         const Rhombus *rhombus = dynamic_cast<const Rhombus*>(&other);
         if (!rhombus) return false;
-        return diagonal1_ == rhombus->diagonal1_ && diagonal2_ == rhombus->diagonal2_ && center_ == rhombus->center_;
+        return *this == *rhombus;
     }
-    Rhombus &operator=(const Rhombus &other){
-        if (this != &other){
-            diagonal1_ = other.diagonal1_;
-            diagonal2_ = other.diagonal2_;
-            center_ = other.center_;
-        }
-        return *this;
-    }
-    Rhombus &operator=(Rhombus &&other) noexcept {
-        if(this != &other) {
-            diagonal1_ = std::move(other.diagonal1_);
-            diagonal2_ = std::move(other.diagonal2_);
-            center_ = std::move(other.center_);
-            other.diagonal1_ = T(0);
-            other.diagonal2_= T(0);
+    size_t hashValue() const override{
+        size_t seed = hashCombine(hashScalar(diagonal1_), hashScalar(diagonal2_));
+        return hashCombine(seed, std::hash<Point<T>>()(center_));
+    }
+    void translate(T dx, T dy) override{
+        center_.translate(dx, dy);
+    }
+    void scale(T factor, T pivot_x, T pivot_y) override{
+        checkScaleFactor(factor);
+        diagonal1_ *= factor;
+        diagonal2_ *= factor;
+        center_.scaleAbout(factor, pivot_x, pivot_y);
+    }
+    bool canRotateQuarterTurns(int) const override{
+        return true;
+    }
+    // An odd number of quarter turns swaps the diagonals.
+    bool rotateQuarterTurns(int quarters, T pivot_x, T pivot_y) override{
+        if (normalizedQuarterTurns(quarters) % 2 == 1){
+            std::swap(diagonal1_, diagonal2_);
         }
-        return *this;
+        center_.rotateQuarterTurns(quarters, pivot_x, pivot_y);
+        return true;
     }
+    Rhombus &operator=(const Rhombus &other) = default;
+    Rhombus &operator=(Rhombus &&other) noexcept = default;
     bool operator==(const Rhombus &other) const{
-        return isEqual(other);
+        return diagonal1_ == other.diagonal1_ && diagonal2_ == other.diagonal2_ && center_ == other.center_;
     }
     T getDiagonal1() const {return diagonal1_;}
     T getDiagonal2() const {return diagonal2_;}
     Point<T> getCenter() const {return center_;}
 };
+
+// Only the vtable pointer and plain fields: safe to move with memcpy.
+template<ScalarType T>
+struct is_trivially_relocatable<Rhombus<T>> : std::true_type{};
+
+template<ScalarType T>
+struct std::hash<Rhombus<T>>{
+    size_t operator()(const Rhombus<T> &rhombus) const{
+        return rhombus.hashValue();
+    }
+};
 #endif
\ No newline at end of file
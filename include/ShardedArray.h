@@ -0,0 +1,216 @@
+#ifndef SHARDEDARRAY_H
+#define SHARDEDARRAY_H
+
+#include "Array.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Dense ids for the threads alive right now. A thread takes the lowest free
+// id on first use and gives it back when it exits, so threads alive at the
+// same time never share an id, and the fresh threads parallelFor starts on
+// every call keep reusing low ids instead of counting upwards.
+class ThreadSlots{
+private:
+    std::mutex mutex_;
+    std::vector<bool> used_;
+
+public:
+    size_t acquire(){
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t slot = static_cast<size_t>(std::find(used_.begin(), used_.end(), false) - used_.begin());
+        if (slot == used_.size()){
+            used_.push_back(true);
+        } else {
+            used_[slot] = true;
+        }
+        return slot;
+    }
+    void release(size_t slot){
+        std::lock_guard<std::mutex> lock(mutex_);
+        used_[slot] = false;
+    }
+};
+
+inline size_t liveThreadSlot(){
+    // Never destroyed: a thread may still exit after static destruction.
+    static ThreadSlots *slots = new ThreadSlots;
+    struct Holder{
+        size_t slot = slots->acquire();
+        ~Holder(){
+            slots->release(slot);
+        }
+    };
+    thread_local Holder holder;
+    return holder.slot;
+}
+
+// Append-only collection that many threads can fill at once. Elements go to
+// one of several shards, each an Array behind its own mutex, so producers
+// on different shards do not contend. seal() gathers everything into one
+// contiguous Array for read-only use (calculateTotalArea and the rest).
+//
+// Works with std::shared_ptr<Figure<T>> as well as inline shapes such as
+// FigureVariant<T>. Order is kept per producer, not across producers.
+template<typename T, typename Alloc = std::allocator<T>>
+class ShardedArray{
+private:
+    // A cache line per shard so neighbouring mutexes are not falsely shared.
+    struct alignas(64) Shard{
+        mutable std::mutex mutex;
+        Array<T, Alloc> items;
+
+        explicit Shard(const Alloc &alloc) : items(alloc){}
+    };
+
+    Alloc alloc_;
+    // A deque never moves its elements, so it can hold the mutexes.
+    std::deque<Shard> shards_;
+    size_t shardCount_;
+
+    // Threads alive at the same time have distinct slots (liveThreadSlot),
+    // so up to shardCount_ concurrent producers never share a shard.
+    Shard &localShard(){
+        return shards_[liveThreadSlot() % shardCount_];
+    }
+
+public:
+    using value_type = T;
+
+    // Batched producer: fills a private Array without locking and moves it
+    // into its shard every batchSize elements and on destruction.
+    class Writer{
+    private:
+        ShardedArray *owner_;
+        Array<T, Alloc> batch_;
+        size_t batchSize_;
+
+    public:
+        Writer(ShardedArray &owner, size_t batch_size)
+            : owner_(&owner), batch_(owner.alloc_), batchSize_(std::max<size_t>(batch_size, 1)){
+            batch_.reserve(batchSize_);
+        }
+        Writer(const Writer &) = delete;
+        Writer &operator=(const Writer &) = delete;
+        Writer(Writer &&other) noexcept : owner_(other.owner_), batch_(std::move(other.batch_)), batchSize_(other.batchSize_){}
+        ~Writer(){
+            try{
+                flush();
+            } catch (...){
+            }
+        }
+
+        template<typename... Args>
+        void emplace_back(Args &&...args){
+            batch_.emplace_back(std::forward<Args>(args)...);
+            if (batch_.size() >= batchSize_){
+                flush();
+            }
+        }
+        void push_back(const T &value){
+            emplace_back(value);
+        }
+        void push_back(T &&value){
+            emplace_back(std::move(value));
+        }
+        void flush(){
+            if (!batch_.empty()){
+                owner_->append(batch_);
+                batch_.clear();
+            }
+        }
+    };
+
+    static constexpr size_t DEFAULT_BATCH_SIZE = 256;
+
+    // Every shard and the sealed Array allocate through alloc.
+    explicit ShardedArray(size_t shards = 2 * static_cast<size_t>(defaultThreadCount()), const Alloc &alloc = Alloc())
+        : alloc_(alloc), shardCount_(std::max<size_t>(shards, 1)){
+        for (size_t i = 0; i < shardCount_; ++i){
+            shards_.emplace_back(alloc_);
+        }
+    }
+    ShardedArray(const ShardedArray &) = delete;
+    ShardedArray &operator=(const ShardedArray &) = delete;
+
+    template<typename... Args>
+    void emplace_back(Args &&...args){
+        Shard &shard = localShard();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.items.emplace_back(std::forward<Args>(args)...);
+    }
+    void push_back(const T &value){
+        emplace_back(value);
+    }
+    void push_back(T &&value){
+        emplace_back(std::move(value));
+    }
+    // Moves all elements of batch into the calling thread's shard under one
+    // lock; batch keeps its moved-from elements.
+    void append(Array<T, Alloc> &batch){
+        Shard &shard = localShard();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t needed = shard.items.size() + batch.size();
+        if (needed > shard.items.capacity()){
+            shard.items.reserve(std::max(needed, 2 * shard.items.capacity()));
+        }
+        for (size_t i = 0; i < batch.size(); ++i){
+            shard.items.push_back(std::move(batch[i]));
+        }
+    }
+    Writer writer(size_t batch_size = DEFAULT_BATCH_SIZE){
+        return Writer(*this, batch_size);
+    }
+
+    size_t size() const{
+        size_t total = 0;
+        for (size_t i = 0; i < shardCount_; ++i){
+            std::lock_guard<std::mutex> lock(shards_[i].mutex);
+            total += shards_[i].items.size();
+        }
+        return total;
+    }
+    size_t shardCount() const {return shardCount_;}
+    Alloc get_allocator() const {return alloc_;}
+
+    // Moves every element into one Array, shard by shard, and leaves the
+    // collection empty. A single non-empty shard is handed over without
+    // moving its elements. Elements still sitting in a live Writer's batch
+    // are not included; producers should finish before sealing.
+    Array<T, Alloc> seal(){
+        std::unique_ptr<std::unique_lock<std::mutex>[]> locks(new std::unique_lock<std::mutex>[shardCount_]);
+        size_t total = 0;
+        size_t filled = 0;
+        size_t last = 0;
+        for (size_t i = 0; i < shardCount_; ++i){
+            locks[i] = std::unique_lock<std::mutex>(shards_[i].mutex);
+            if (!shards_[i].items.empty()){
+                total += shards_[i].items.size();
+                ++filled;
+                last = i;
+            }
+        }
+        if (filled <= 1){
+            Array<T, Alloc> result(std::move(shards_[last].items));
+            shards_[last].items = Array<T, Alloc>(alloc_);
+            return result;
+        }
+        Array<T, Alloc> result(alloc_);
+        result.reserve(total);
+        for (size_t i = 0; i < shardCount_; ++i){
+            Array<T, Alloc> &items = shards_[i].items;
+            for (size_t j = 0; j < items.size(); ++j){
+                result.push_back(std::move(items[j]));
+            }
+            items = Array<T, Alloc>(alloc_);
+        }
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef SMALLARRAY_H
+#define SMALLARRAY_H
+
+#include <utility>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <initializer_list>
+
+// Array with room for N elements inside the object itself; the heap is
+// touched only once the size grows past N.
+template<typename T, size_t N>
+class SmallArray {
+    static_assert(N > 0, "SmallArray needs a non-empty inline buffer");
+
+private:
+    alignas(T) unsigned char inline_[N * sizeof(T)];
+    T *data_;
+    size_t size_;
+    size_t capacity_;
+
+    T *inlineData(){
+        return reinterpret_cast<T*>(inline_);
+    }
+    const T *inlineData() const{
+        return reinterpret_cast<const T*>(inline_);
+    }
+    bool isInline() const{
+        return data_ == inlineData();
+    }
+    void destroyAll(){
+        std::destroy(data_, data_ + size_);
+    }
+    void freeHeap(){
+        if (!isInline()){
+            std::allocator<T>().deallocate(data_, capacity_);
+        }
+    }
+    // Moves the live elements into storage of new_capacity (inline when it fits).
+    void reallocate(size_t new_capacity){
+        T *new_data = new_capacity <= N ? inlineData() : std::allocator<T>().allocate(new_capacity);
+        if (new_data == data_){
+            return;
+        }
+        try{
+            std::uninitialized_move(data_, data_ + size_, new_data);
+        } catch (...){
+            if (new_data != inlineData()){
+                std::allocator<T>().deallocate(new_data, new_capacity);
+            }
+            throw;
+        }
+        destroyAll();
+        freeHeap();
+        data_ = new_data;
+        capacity_ = new_capacity <= N ? N : new_capacity;
+    }
+    void takeFrom(SmallArray &other){
+        if (other.isInline()){
+            std::uninitialized_move(other.data_, other.data_ + other.size_, data_);
+            size_ = other.size_;
+            other.clear();
+        } else {
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.data_ = other.inlineData();
+            other.size_ = 0;
+            other.capacity_ = N;
+        }
+    }
+
+public:
+    using value_type = T;
+
+    SmallArray() : data_(inlineData()), size_(0), capacity_(N){}
+    explicit SmallArray(size_t size) : SmallArray(){
+        reserve(size);
+        for (; size_ < size; ++size_){
+            new (data_ + size_) T();
+        }
+    }
+    SmallArray(std::initializer_list<T> init) : SmallArray(){
+        reserve(init.size());
+        for (const auto &item : init){
+            new (data_ + size_) T(item);
+            ++size_;
+        }
+    }
+    SmallArray(const SmallArray &other) : SmallArray(){
+        reserve(other.size_);
+        for (; size_ < other.size_; ++size_){
+            new (data_ + size_) T(other.data_[size_]);
+        }
+    }
+    SmallArray(SmallArray &&other) noexcept(std::is_nothrow_move_constructible_v<T>) : SmallArray(){
+        takeFrom(other);
+    }
+    ~SmallArray(){
+        destroyAll();
+        freeHeap();
+    }
+    SmallArray &operator=(const SmallArray &other){
+        if (this != &other){
+            SmallArray copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+    SmallArray &operator=(SmallArray &&other) noexcept(std::is_nothrow_move_constructible_v<T>){
+        if (this != &other){
+            destroyAll();
+            freeHeap();
+            data_ = inlineData();
+            size_ = 0;
+            capacity_ = N;
+            takeFrom(other);
+        }
+        return *this;
+    }
+    T &operator[](size_t index){
+        if (index >= size_){
+            throw std::out_of_range("SmallArray index out of bounds");
+        }
+        return data_[index];
+    }
+    const T &operator[](size_t index) const{
+        if (index >= size_){
+            throw std::out_of_range("SmallArray index out of bounds");
+        }
+        return data_[index];
+    }
+    template<typename... Args>
+    T &emplace_back(Args &&...args){
+        if (size_ >= capacity_){
+            // Build the element first so args may alias the current buffer.
+            T value(std::forward<Args>(args)...);
+            reallocate(capacity_ * 2);
+            new (data_ + size_) T(std::move(value));
+        } else {
+            new (data_ + size_) T(std::forward<Args>(args)...);
+        }
+        return data_[size_++];
+    }
+    void push_back(const T &value){
+        emplace_back(value);
+    }
+    void push_back(T &&value){
+        emplace_back(std::move(value));
+    }
+    void reserve(size_t new_capacity){
+        if (new_capacity > capacity_){
+            reallocate(new_capacity);
+        }
+    }
+    void shrink_to_fit(){
+        if (!isInline() && size_ < capacity_){
+            reallocate(size_);
+        }
+    }
+    void remove(size_t index){
+        if (index >= size_){
+            throw std::out_of_range("SmallArray index out of bounds");
+        }
+        for (size_t i = index; i < size_ - 1; ++i){
+            data_[i] = std::move(data_[i + 1]);
+        }
+        std::destroy_at(data_ + size_ - 1);
+        --size_;
+    }
+    void swap_remove(size_t index){
+        if (index >= size_){
+            throw std::out_of_range("SmallArray index out of bounds");
+        }
+        if (index != size_ - 1){
+            data_[index] = std::move(data_[size_ - 1]);
+        }
+        std::destroy_at(data_ + size_ - 1);
+        --size_;
+    }
+    void erase(size_t first, size_t last){
+        if (first > last || last > size_){
+            throw std::out_of_range("SmallArray erase range out of bounds");
+        }
+        T *new_end = std::move(data_ + last, data_ + size_, data_ + first);
+        std::destroy(new_end, data_ + size_);
+        size_ -= last - first;
+    }
+    template<typename Predicate>
+    size_t erase_if(Predicate pred){
+        size_t kept = 0;
+        for (size_t i = 0; i < size_; ++i){
+            if (!pred(std::as_const(data_[i]))){
+                if (kept != i){
+                    data_[kept] = std::move(data_[i]);
+                }
+                ++kept;
+            }
+        }
+        size_t removed = size_ - kept;
+        std::destroy(data_ + kept, data_ + size_);
+        size_ = kept;
+        return removed;
+    }
+    void clear(){
+        destroyAll();
+        size_ = 0;
+    }
+    size_t size() const {return size_;}
+    size_t capacity() const {return capacity_;}
+    bool empty() const {return size_ == 0;}
+    bool isInlineStorage() const {return isInline();}
+    T* begin() {return data_;}
+    const T* begin() const{return data_;}
+    T* end() {return data_ + size_;}
+    const T* end() const{return data_ + size_;}
+};
+
+#endif
@@ -0,0 +1,308 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include "Figure.h"
+#include "Array.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Uniform grid over figure bounding boxes. Every figure is linked into each
+// cell its box overlaps; queries only visit the cells they touch. Figures
+// whose box covers more than LARGE_FIGURE_CELLS cells, or is not finite,
+// are kept in a separate list that every query scans, as in the broad phase
+// of findOverlappingPairs. Handles returned by insert() stay valid until
+// remove() and are never reused.
+template<ScalarType T>
+class SpatialGrid{
+private:
+    struct Entry{
+        std::shared_ptr<Figure<T>> figure;
+        BoundingBox box;
+        double centerX;
+        double centerY;
+        bool alive;
+        bool large;
+    };
+
+    double cellSize_;
+    std::vector<Entry> entries_;
+    std::unordered_map<uint64_t, std::vector<size_t>> cells_;
+    std::vector<size_t> large_;
+    size_t alive_;
+    // Extent of every cell ever occupied; it only grows.
+    int64_t minCellX_;
+    int64_t minCellY_;
+    int64_t maxCellX_;
+    int64_t maxCellY_;
+
+    int64_t cellCoord(double value) const{
+        double cell = std::floor(value / cellSize_);
+        return static_cast<int64_t>(std::clamp(cell, -2147483647.0, 2147483647.0));
+    }
+    static uint64_t cellKey(int64_t x, int64_t y){
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    }
+    const std::vector<size_t> *cellAt(int64_t x, int64_t y) const{
+        auto it = cells_.find(cellKey(x, y));
+        return it == cells_.end() ? nullptr : &it->second;
+    }
+    bool isLarge(const BoundingBox &box) const{
+        if (!std::isfinite(box.minX) || !std::isfinite(box.minY) || !std::isfinite(box.maxX) || !std::isfinite(box.maxY)){
+            return true;
+        }
+        double columns = std::floor(box.maxX / cellSize_) - std::floor(box.minX / cellSize_) + 1.0;
+        double rows = std::floor(box.maxY / cellSize_) - std::floor(box.minY / cellSize_) + 1.0;
+        return columns * rows > static_cast<double>(LARGE_FIGURE_CELLS);
+    }
+    void link(size_t handle){
+        const BoundingBox &box = entries_[handle].box;
+        if (entries_[handle].large){
+            large_.push_back(handle);
+            return;
+        }
+        int64_t x0 = cellCoord(box.minX), x1 = cellCoord(box.maxX);
+        int64_t y0 = cellCoord(box.minY), y1 = cellCoord(box.maxY);
+        for (int64_t x = x0; x <= x1; ++x){
+            for (int64_t y = y0; y <= y1; ++y){
+                cells_[cellKey(x, y)].push_back(handle);
+            }
+        }
+        minCellX_ = std::min(minCellX_, x0);
+        minCellY_ = std::min(minCellY_, y0);
+        maxCellX_ = std::max(maxCellX_, x1);
+        maxCellY_ = std::max(maxCellY_, y1);
+    }
+    void unlink(size_t handle){
+        const BoundingBox &box = entries_[handle].box;
+        if (entries_[handle].large){
+            auto pos = std::find(large_.begin(), large_.end(), handle);
+            *pos = large_.back();
+            large_.pop_back();
+            return;
+        }
+        for (int64_t x = cellCoord(box.minX); x <= cellCoord(box.maxX); ++x){
+            for (int64_t y = cellCoord(box.minY); y <= cellCoord(box.maxY); ++y){
+                auto it = cells_.find(cellKey(x, y));
+                auto &handles = it->second;
+                auto pos = std::find(handles.begin(), handles.end(), handle);
+                *pos = handles.back();
+                handles.pop_back();
+                if (handles.empty()){
+                    cells_.erase(it);
+                }
+            }
+        }
+    }
+    // Mean of the larger box side: big enough that a typical figure spans
+    // few cells, small enough that a cell holds few figures.
+    static double chooseCellSize(const Array<std::shared_ptr<Figure<T>>> &figures){
+        double total = 0.0;
+        for (size_t i = 0; i < figures.size(); ++i){
+            BoundingBox box = figures[i]->boundingBox();
+            total += std::max(box.maxX - box.minX, box.maxY - box.minY);
+        }
+        double size = figures.empty() ? 0.0 : total / static_cast<double>(figures.size());
+        return std::isfinite(size) && size > 0.0 ? size : 1.0;
+    }
+
+public:
+    static constexpr size_t LARGE_FIGURE_CELLS = 64;
+
+    explicit SpatialGrid(double cell_size) : cellSize_(cell_size), alive_(0),
+        minCellX_(INT64_MAX), minCellY_(INT64_MAX), maxCellX_(INT64_MIN), maxCellY_(INT64_MIN){
+        if (!(cell_size > 0.0) || !std::isfinite(cell_size)){
+            throw std::invalid_argument("SpatialGrid: cell size must be positive");
+        }
+    }
+    // Bulk load; the handle of figures[i] is i.
+    explicit SpatialGrid(const Array<std::shared_ptr<Figure<T>>> &figures) : SpatialGrid(chooseCellSize(figures)){
+        entries_.reserve(figures.size());
+        for (size_t i = 0; i < figures.size(); ++i){
+            insert(figures[i]);
+        }
+    }
+
+    size_t insert(std::shared_ptr<Figure<T>> figure){
+        BoundingBox box = figure->boundingBox();
+        Point<T> center = figure->calculateCenter();
+        entries_.push_back({std::move(figure), box, static_cast<double>(center.x()), static_cast<double>(center.y()), true, isLarge(box)});
+        link(entries_.size() - 1);
+        ++alive_;
+        return entries_.size() - 1;
+    }
+    void remove(size_t handle){
+        if (handle >= entries_.size() || !entries_[handle].alive){
+            throw std::out_of_range("SpatialGrid: invalid handle");
+        }
+        unlink(handle);
+        entries_[handle].alive = false;
+        entries_[handle].figure.reset();
+        --alive_;
+    }
+
+    // Figures whose bounding box intersects range.
+    std::vector<size_t> queryRange(const BoundingBox &range) const{
+        std::vector<size_t> result;
+        if (range.empty() || alive_ == 0){
+            return result;
+        }
+        for (size_t handle : large_){
+            if (entries_[handle].box.intersects(range)){
+                result.push_back(handle);
+            }
+        }
+        if (cells_.empty()){
+            return result;
+        }
+        int64_t x0 = std::max(cellCoord(range.minX), minCellX_), x1 = std::min(cellCoord(range.maxX), maxCellX_);
+        int64_t y0 = std::max(cellCoord(range.minY), minCellY_), y1 = std::min(cellCoord(range.maxY), maxCellY_);
+        if (x0 > x1 || y0 > y1){
+            return result;
+        }
+        // A figure linked into several cells is reported only from the cell
+        // holding the lower corner of its overlap with the range.
+        auto visit = [&](int64_t x, int64_t y, const std::vector<size_t> &handles){
+            for (size_t handle : handles){
+                const BoundingBox &box = entries_[handle].box;
+                if (box.intersects(range)
+                    && cellCoord(std::max(box.minX, range.minX)) == x
+                    && cellCoord(std::max(box.minY, range.minY)) == y){
+                    result.push_back(handle);
+                }
+            }
+        };
+        double span = static_cast<double>(x1 - x0 + 1) * static_cast<double>(y1 - y0 + 1);
+        if (span > static_cast<double>(cells_.size())){
+            for (const auto &[key, handles] : cells_){
+                int64_t x = static_cast<int32_t>(key >> 32);
+                int64_t y = static_cast<int32_t>(key & 0xffffffffu);
+                if (x0 <= x && x <= x1 && y0 <= y && y <= y1){
+                    visit(x, y, handles);
+                }
+            }
+        } else {
+            for (int64_t x = x0; x <= x1; ++x){
+                for (int64_t y = y0; y <= y1; ++y){
+                    if (const auto *handles = cellAt(x, y)){
+                        visit(x, y, *handles);
+                    }
+                }
+            }
+        }
+        return result;
+    }
+    // Candidates whose bounding box contains the point (exact containment
+    // still has to be checked against the shape).
+    std::vector<size_t> queryPoint(double x, double y) const{
+        std::vector<size_t> result;
+        if (alive_ == 0){
+            return result;
+        }
+        for (size_t handle : large_){
+            if (entries_[handle].box.contains(x, y)){
+                result.push_back(handle);
+            }
+        }
+        if (const auto *handles = cellAt(cellCoord(x), cellCoord(y))){
+            for (size_t handle : *handles){
+                if (entries_[handle].box.contains(x, y)){
+                    result.push_back(handle);
+                }
+            }
+        }
+        return result;
+    }
+    // Up to k handles ordered by distance from (x, y) to the figure center.
+    // Rings of cells are scanned outwards until no closer center can remain.
+    std::vector<size_t> nearestCenters(double x, double y, size_t k) const{
+        std::vector<size_t> result;
+        if (k == 0 || alive_ == 0){
+            return result;
+        }
+        std::priority_queue<std::pair<double, size_t>> best;
+        auto consider = [&](size_t handle){
+            const Entry &entry = entries_[handle];
+            double dx = entry.centerX - x, dy = entry.centerY - y;
+            double distance = dx * dx + dy * dy;
+            if (best.size() < k){
+                best.emplace(distance, handle);
+            } else if (distance < best.top().first){
+                best.pop();
+                best.emplace(distance, handle);
+            }
+        };
+        for (size_t handle : large_){
+            consider(handle);
+        }
+        int64_t px = cellCoord(x), py = cellCoord(y);
+        // With no linked figures the cell extent is still empty.
+        int64_t first_ring = 0, last_ring = -1;
+        if (!cells_.empty()){
+            first_ring = std::max({int64_t(0), minCellX_ - px, px - maxCellX_, minCellY_ - py, py - maxCellY_});
+            last_ring = std::max({px - minCellX_, maxCellX_ - px, py - minCellY_, maxCellY_ - py});
+        }
+        auto visit = [&](int64_t cx, int64_t cy){
+            if (cx < minCellX_ || cx > maxCellX_ || cy < minCellY_ || cy > maxCellY_){
+                return;
+            }
+            const auto *handles = cellAt(cx, cy);
+            if (!handles){
+                return;
+            }
+            for (size_t handle : *handles){
+                const Entry &entry = entries_[handle];
+                // Each figure is considered once, from the cell of its center.
+                if (cellCoord(entry.centerX) != cx || cellCoord(entry.centerY) != cy){
+                    continue;
+                }
+                consider(handle);
+            }
+        };
+        for (int64_t ring = first_ring; ring <= last_ring; ++ring){
+            double reach = static_cast<double>(std::max<int64_t>(ring - 1, 0)) * cellSize_;
+            if (best.size() == k && best.top().first <= reach * reach){
+                break;
+            }
+            if (ring == 0){
+                visit(px, py);
+                continue;
+            }
+            for (int64_t cx = std::max(px - ring, minCellX_); cx <= std::min(px + ring, maxCellX_); ++cx){
+                visit(cx, py - ring);
+                visit(cx, py + ring);
+            }
+            for (int64_t cy = std::max(py - ring + 1, minCellY_); cy <= std::min(py + ring - 1, maxCellY_); ++cy){
+                visit(px - ring, cy);
+                visit(px + ring, cy);
+            }
+        }
+        result.resize(best.size());
+        for (size_t i = result.size(); i-- > 0;){
+            result[i] = best.top().second;
+            best.pop();
+        }
+        return result;
+    }
+
+    const std::shared_ptr<Figure<T>> &figure(size_t handle) const{
+        if (handle >= entries_.size() || !entries_[handle].alive){
+            throw std::out_of_range("SpatialGrid: invalid handle");
+        }
+        return entries_[handle].figure;
+    }
+    const BoundingBox &box(size_t handle) const{
+        return entries_.at(handle).box;
+    }
+    size_t size() const {return alive_;}
+    bool empty() const {return alive_ == 0;}
+    double cellSize() const {return cellSize_;}
+};
+
+#endif
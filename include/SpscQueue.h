@@ -0,0 +1,149 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// The ring holds capacity slots (rounded up to a power of two); push() waits
+// while it is full, which is what throttles a fast producer.
+//
+// close() is called by the producer after its last push: pop() then drains
+// what is left and returns false. cancel() may be called from either side
+// and makes every waiting and later push() or pop() return false.
+//
+// A waiting side spins briefly and then sleeps on a futex-backed counter
+// (std::atomic::wait) until the other side pushes, pops, closes or cancels,
+// so a stage starved by slow I/O does not keep a core busy.
+template<typename T>
+class SpscQueue{
+private:
+    // Producer and consumer indices live on separate cache lines, and each
+    // side keeps a copy of the other's index so it only reads the shared one
+    // when the ring looks full or empty.
+    struct alignas(64) ProducerSide{
+        std::atomic<size_t> tail{0};
+        size_t cachedHead = 0;
+        // Bumped on every push, close and cancel; the consumer sleeps on it.
+        std::atomic<unsigned> signal{0};
+    };
+    struct alignas(64) ConsumerSide{
+        std::atomic<size_t> head{0};
+        size_t cachedTail = 0;
+        // Bumped on every pop and cancel; the producer sleeps on it.
+        std::atomic<unsigned> signal{0};
+    };
+
+    static constexpr unsigned SPIN_LIMIT = 64;
+
+    std::unique_ptr<T[]> slots_;
+    size_t mask_;
+    ProducerSide producer_;
+    ConsumerSide consumer_;
+    alignas(64) std::atomic<bool> closed_{false};
+    std::atomic<bool> cancelled_{false};
+
+    static size_t roundUpToPowerOfTwo(size_t value){
+        size_t result = 1;
+        while (result < value){
+            result <<= 1;
+        }
+        return result;
+    }
+    static void wake(std::atomic<unsigned> &signal){
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_all();
+    }
+    // Spins briefly, then sleeps until signal moves past seen. seen is read
+    // before the failed attempt, so a change in between is never missed.
+    static void backOff(unsigned &spins, const std::atomic<unsigned> &signal, unsigned seen){
+        if (++spins < SPIN_LIMIT){
+            return;
+        }
+        signal.wait(seen, std::memory_order_acquire);
+    }
+
+public:
+    explicit SpscQueue(size_t capacity)
+        : slots_(std::make_unique<T[]>(roundUpToPowerOfTwo(std::max<size_t>(capacity, 2)))),
+          mask_(roundUpToPowerOfTwo(std::max<size_t>(capacity, 2)) - 1){}
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    bool tryPush(T &value){
+        size_t tail = producer_.tail.load(std::memory_order_relaxed);
+        if (tail - producer_.cachedHead > mask_){
+            producer_.cachedHead = consumer_.head.load(std::memory_order_acquire);
+            if (tail - producer_.cachedHead > mask_){
+                return false;
+            }
+        }
+        slots_[tail & mask_] = std::move(value);
+        producer_.tail.store(tail + 1, std::memory_order_release);
+        wake(producer_.signal);
+        return true;
+    }
+    bool tryPop(T &out){
+        size_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (head == consumer_.cachedTail){
+            consumer_.cachedTail = producer_.tail.load(std::memory_order_acquire);
+            if (head == consumer_.cachedTail){
+                return false;
+            }
+        }
+        out = std::move(slots_[head & mask_]);
+        consumer_.head.store(head + 1, std::memory_order_release);
+        wake(consumer_.signal);
+        return true;
+    }
+
+    // Returns false if the queue was cancelled before value got in.
+    bool push(T value){
+        for (unsigned spins = 0;;){
+            unsigned seen = consumer_.signal.load(std::memory_order_acquire);
+            if (cancelled_.load(std::memory_order_acquire)){
+                return false;
+            }
+            if (tryPush(value)){
+                return true;
+            }
+            backOff(spins, consumer_.signal, seen);
+        }
+    }
+    // Returns false once the queue is closed and drained, or cancelled.
+    bool pop(T &out){
+        for (unsigned spins = 0;;){
+            unsigned seen = producer_.signal.load(std::memory_order_acquire);
+            if (cancelled_.load(std::memory_order_acquire)){
+                return false;
+            }
+            if (tryPop(out)){
+                return true;
+            }
+            if (closed_.load(std::memory_order_acquire)){
+                // Everything pushed before close() is visible now.
+                return tryPop(out);
+            }
+            backOff(spins, producer_.signal, seen);
+        }
+    }
+
+    void close(){
+        closed_.store(true, std::memory_order_release);
+        wake(producer_.signal);
+    }
+    void cancel(){
+        cancelled_.store(true, std::memory_order_release);
+        wake(producer_.signal);
+        wake(consumer_.signal);
+    }
+    bool cancelled() const{
+        return cancelled_.load(std::memory_order_acquire);
+    }
+    size_t capacity() const {return mask_ + 1;}
+};
+
+#endif
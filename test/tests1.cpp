@@ -5,12 +5,33 @@
 #include "../include/Point.h"
 #include "../include/Figure.h"
 #include "../include/FigureUtils.h"
+#include "../include/FigureStore.h"
+#include "../include/FigureVariant.h"
+#include "../include/SmallArray.h"
+#include "../include/CowArray.h"
+#include "../include/SpatialGrid.h"
+#include "../include/FigureFile.h"
+#include "../include/FigureParser.h"
+#include "../include/FigureExporter.h"
+#include "../include/CachedFigure.h"
+#include "../include/Collision.h"
+#include "../include/ShardedArray.h"
+#include "../include/SpscQueue.h"
+#include "../include/FigurePipeline.h"
+#include "../include/FigureCollection.h"
 #include <gtest/gtest.h>
 #include <iostream>
 #include <sstream>
 #include <memory>
 #include <vector>
 #include <cmath>
+#include <memory_resource>
+#include <algorithm>
+#include <random>
+#include <fstream>
+#include <unordered_set>
+#include <thread>
+#include <chrono>
 
 using namespace std;
 
@@ -421,3 +442,1549 @@ TEST(test_59, ArrayWithFigurePointersAndDirect) {
         delete polyArray[i];
     }
 }
+
+TEST(test_60, FigureStoreMatchesPolymorphicTotal) {
+    Array<shared_ptr<Figure<double>>> figures;
+    for (int i = 0; i < 37; ++i) {
+        figures.push_back(make_shared<Rhombus<double>>(1.0 + i, 2.5 + i, i, -i));
+        figures.push_back(make_shared<Pentagon<double>>(0.5 + i, i, i));
+        figures.push_back(make_shared<Hexagon<double>>(1.5 + i, -i, i));
+    }
+
+    FigureStore<double> store(figures);
+    EXPECT_EQ(store.size(), figures.size());
+    EXPECT_EQ(store.rhombusCount(), 37);
+    EXPECT_EQ(store.pentagonCount(), 37);
+    EXPECT_EQ(store.hexagonCount(), 37);
+
+    double expected = calculateTotalArea(figures);
+    EXPECT_NEAR(calculateTotalArea(store), expected, expected * 1e-12);
+}
+
+TEST(test_61, FigureStorePerKindArea) {
+    FigureStore<int> store;
+    store.addRhombus(6, 8, 0, 0);
+    store.addRhombus(4, 5, 1, 1);
+    store.addPentagon(1, 0, 0);
+    store.addHexagon(2, 0, 0);
+
+    EXPECT_DOUBLE_EQ(store.rhombusArea(), 34.0);
+    EXPECT_NEAR(store.pentagonArea(), Pentagon<int>(1, 0, 0).calculateArea(), 1e-12);
+    EXPECT_NEAR(store.hexagonArea(), Hexagon<int>(2, 0, 0).calculateArea(), 1e-12);
+    EXPECT_EQ(store.rhombuses().x[1], 1);
+
+    store.clear();
+    EXPECT_TRUE(store.empty());
+    EXPECT_DOUBLE_EQ(store.totalArea(), 0.0);
+}
+
+TEST(test_62, WriteVerticesMatchesGetVertices) {
+    Array<shared_ptr<Figure<double>>> figures;
+    figures.push_back(make_shared<Rhombus<double>>(4.0, 6.0, 1.0, 2.0));
+    figures.push_back(make_shared<Pentagon<double>>(2.0, -1.0, 3.0));
+    figures.push_back(make_shared<Hexagon<double>>(3.0, 0.5, 0.5));
+
+    for (const auto &figure : figures) {
+        Point<double> buffer[Figure<double>::MAX_VERTICES];
+        size_t count = figure->writeVertices(buffer);
+        auto expected = figure->getVertices();
+        ASSERT_EQ(count, figure->vertexCount());
+        ASSERT_EQ(count, expected.size());
+        for (size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(buffer[i], *expected[i]);
+        }
+    }
+}
+
+TEST(test_63, FixedSizeVertexArray) {
+    Hexagon<double> hexagon(2.0, 0.0, 0.0);
+    auto vertices = hexagon.vertices();
+    static_assert(std::tuple_size_v<decltype(vertices)> == 6);
+    EXPECT_DOUBLE_EQ(vertices[0].x(), 2.0);
+    EXPECT_NEAR(vertices[3].x(), -2.0, 1e-12);
+
+    Rhombus<int> rhombus(4, 6, 0, 0);
+    EXPECT_EQ(rhombus.vertices()[0], Point<int>(0, 3));
+
+    std::ostringstream os;
+    rhombus.printVertices(os);
+    EXPECT_EQ(os.str(), "Rhombus vertices:\n(0, 3)\n(2, 0)\n(0, -3)\n(-2, 0)\n");
+}
+
+TEST(test_64, RegularPolygonTablesMatchRuntimeTrig) {
+    static_assert(RegularPolygonTable<5>::AREA_COEFFICIENT > 1.72);
+    EXPECT_NEAR(RegularPolygonTable<5>::AREA_COEFFICIENT, 5.0 / (4.0 * tan(M_PI / 5.0)), 1e-14);
+    EXPECT_NEAR(RegularPolygonTable<6>::AREA_COEFFICIENT, 3.0 * sqrt(3.0) / 2.0, 1e-14);
+
+    Pentagon<double> pentagon(2.0, 1.0, -1.0);
+    auto vertices = pentagon.vertices();
+    double R = 2.0 / (2.0 * sin(M_PI / 5.0));
+    for (size_t i = 0; i < 5; ++i) {
+        double angle = 2.0 * M_PI * i / 5.0 - M_PI / 2.0;
+        EXPECT_NEAR(vertices[i].x(), 1.0 + R * cos(angle), 1e-12);
+        EXPECT_NEAR(vertices[i].y(), -1.0 + R * sin(angle), 1e-12);
+    }
+}
+
+TEST(test_65, OctagonFromRegularPolygon) {
+    Octagon<double> octagon(1.0, 0.0, 0.0);
+    EXPECT_NEAR(octagon.calculateArea(), 2.0 * (1.0 + sqrt(2.0)), 1e-12);
+    EXPECT_EQ(octagon.getVertices().size(), 8);
+    EXPECT_TRUE(octagon.isEqual(Octagon<double>(1.0, 0.0, 0.0)));
+
+    Hexagon<double> hexagon(1.0, 0.0, 0.0);
+    EXPECT_FALSE(hexagon.isEqual(octagon));
+}
+
+TEST(test_66, FigureVariantOperations) {
+    Array<FigureVariant<double>> figures;
+    figures.push_back(Rhombus<double>(4.0, 5.0, 1.0, 2.0));
+    figures.push_back(Pentagon<double>(1.0, 0.0, 0.0));
+    figures.push_back(Hexagon<double>(2.0, 3.0, 3.0));
+
+    EXPECT_DOUBLE_EQ(figureArea(figures[0]), 10.0);
+    EXPECT_EQ(figureCenter(figures[2]), Point<double>(3.0, 3.0));
+
+    Point<double> buffer[Figure<double>::MAX_VERTICES];
+    EXPECT_EQ(figureVertices(figures[1], buffer), 5);
+
+    EXPECT_TRUE(figuresEqual(figures[0], FigureVariant<double>(Rhombus<double>(4.0, 5.0, 1.0, 2.0))));
+    EXPECT_FALSE(figuresEqual(figures[1], FigureVariant<double>(Hexagon<double>(1.0, 0.0, 0.0))));
+}
+
+TEST(test_67, FigureVariantRoundTrip) {
+    Array<shared_ptr<Figure<double>>> figures;
+    figures.push_back(make_shared<Rhombus<double>>(8.0, 6.0, 2.0, 3.0));
+    figures.push_back(make_shared<Pentagon<double>>(5.0, 0.0, 0.0));
+    figures.push_back(make_shared<Hexagon<double>>(4.0, 1.0, 1.0));
+
+    auto variants = toVariantArray(figures);
+    EXPECT_EQ(variants.size(), 3);
+    EXPECT_NEAR(calculateTotalArea(variants), calculateTotalArea(figures), 1e-12);
+
+    auto back = toFigureArray(variants);
+    for (size_t i = 0; i < figures.size(); ++i) {
+        EXPECT_TRUE(back[i]->isEqual(*figures[i]));
+    }
+
+    Array<shared_ptr<Figure<double>>> unsupported;
+    unsupported.push_back(make_shared<Octagon<double>>(1.0, 0.0, 0.0));
+    EXPECT_THROW(toVariantArray(unsupported), std::invalid_argument);
+}
+
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+    size_t bytes = 0;
+
+private:
+    void *do_allocate(size_t size, size_t alignment) override {
+        ++allocations;
+        bytes += size;
+        return std::pmr::new_delete_resource()->allocate(size, alignment);
+    }
+    void do_deallocate(void *p, size_t size, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+};
+
+struct ConstructionCounter {
+    static inline int constructed = 0;
+    int value;
+    ConstructionCounter() : value(0) { ++constructed; }
+    explicit ConstructionCounter(int v) : value(v) { ++constructed; }
+    ConstructionCounter(const ConstructionCounter &other) : value(other.value) { ++constructed; }
+    ConstructionCounter(ConstructionCounter &&other) noexcept : value(other.value) { ++constructed; }
+    ConstructionCounter &operator=(const ConstructionCounter &) = default;
+    ConstructionCounter &operator=(ConstructionCounter &&) = default;
+};
+
+TEST(test_68, ArrayReserveKeepsCapacityUninitialized) {
+    ConstructionCounter::constructed = 0;
+    Array<ConstructionCounter> arr;
+    arr.reserve(100);
+    EXPECT_EQ(arr.capacity(), 100);
+    EXPECT_EQ(ConstructionCounter::constructed, 0);
+
+    for (int i = 0; i < 100; ++i) {
+        arr.emplace_back(i);
+    }
+    EXPECT_EQ(ConstructionCounter::constructed, 100);
+    EXPECT_EQ(arr[99].value, 99);
+
+    arr.remove(0);
+    arr.shrink_to_fit();
+    EXPECT_EQ(arr.capacity(), 99);
+    EXPECT_EQ(arr[0].value, 1);
+}
+
+TEST(test_69, PmrArrayBulkLoadSingleAllocation) {
+    CountingResource upstream;
+    {
+        std::pmr::monotonic_buffer_resource arena(&upstream);
+        PmrArray<shared_ptr<Figure<double>>> figures{std::pmr::polymorphic_allocator<shared_ptr<Figure<double>>>(&arena)};
+        figures.reserve(1000);
+        for (int i = 0; i < 1000; ++i) {
+            figures.emplace_back(make_shared<Rhombus<double>>(2.0, 3.0, i, i));
+        }
+        EXPECT_EQ(upstream.allocations, 1);
+        EXPECT_DOUBLE_EQ(calculateTotalArea(figures), 3000.0);
+    }
+}
+
+TEST(test_70, ArrayMoveAssignAndSelfAppend) {
+    Array<int> arr = {1, 2, 3, 4};
+    arr.push_back(arr[0]);
+    EXPECT_EQ(arr[4], 1);
+
+    Array<int> other;
+    other = std::move(arr);
+    EXPECT_EQ(other.size(), 5);
+    EXPECT_EQ(arr.size(), 0);
+
+    Array<int> copy;
+    copy = other;
+    EXPECT_EQ(copy[3], 4);
+}
+
+TEST(test_71, SmallArrayStaysInline) {
+    SmallArray<int, 4> arr = {1, 2, 3};
+    EXPECT_TRUE(arr.isInlineStorage());
+    EXPECT_EQ(arr.capacity(), 4);
+
+    arr.push_back(4);
+    EXPECT_TRUE(arr.isInlineStorage());
+
+    arr.push_back(arr[0]);
+    EXPECT_FALSE(arr.isInlineStorage());
+    EXPECT_EQ(arr.capacity(), 8);
+    EXPECT_EQ(arr[4], 1);
+
+    arr.remove(0);
+    arr.remove(0);
+    arr.shrink_to_fit();
+    EXPECT_TRUE(arr.isInlineStorage());
+    EXPECT_EQ(arr[0], 3);
+    EXPECT_EQ(arr.size(), 3);
+    EXPECT_THROW(arr[3], std::out_of_range);
+}
+
+TEST(test_72, SmallArrayCopyMoveAndTotalArea) {
+    SmallArray<shared_ptr<Figure<double>>, 2> figures;
+    figures.push_back(make_shared<Rhombus<double>>(4.0, 5.0, 0.0, 0.0));
+    figures.push_back(make_shared<Rhombus<double>>(2.0, 2.0, 0.0, 0.0));
+    figures.push_back(make_shared<Rhombus<double>>(6.0, 8.0, 0.0, 0.0));
+    EXPECT_DOUBLE_EQ(calculateTotalArea(figures), 36.0);
+
+    auto copied = figures;
+    EXPECT_EQ(copied.size(), 3);
+    auto moved = std::move(figures);
+    EXPECT_EQ(moved.size(), 3);
+    EXPECT_EQ(figures.size(), 0);
+    EXPECT_DOUBLE_EQ(calculateTotalArea(moved), 36.0);
+
+    SmallArray<shared_ptr<Figure<double>>, 4> inlineFigures;
+    inlineFigures.push_back(make_shared<Pentagon<double>>(1.0, 0.0, 0.0));
+    auto movedInline = std::move(inlineFigures);
+    EXPECT_TRUE(movedInline.isInlineStorage());
+    EXPECT_EQ(movedInline.size(), 1);
+}
+
+TEST(test_73, CowArraySharesUntilMutation) {
+    CowArray<int> original = {1, 2, 3};
+    CowArray<int> snapshot = original;
+    EXPECT_TRUE(original.isShared());
+    EXPECT_EQ(std::as_const(snapshot).begin(), std::as_const(original).begin());
+
+    original[0] = 10;
+    EXPECT_FALSE(original.isShared());
+    EXPECT_EQ(original[0], 10);
+    EXPECT_EQ(std::as_const(snapshot)[0], 1);
+
+    CowArray<int> second = snapshot;
+    second.push_back(4);
+    EXPECT_EQ(second.size(), 4);
+    EXPECT_EQ(snapshot.size(), 3);
+
+    CowArray<int> third = snapshot;
+    third.clear();
+    EXPECT_TRUE(third.empty());
+    EXPECT_EQ(snapshot.size(), 3);
+
+    CowArray<int> fourth = snapshot;
+    fourth.remove(0);
+    EXPECT_EQ(std::as_const(fourth)[0], 2);
+    EXPECT_EQ(std::as_const(snapshot)[0], 1);
+}
+
+TEST(test_74, CowArrayFigureSnapshot) {
+    Array<shared_ptr<Figure<double>>> figures;
+    figures.push_back(make_shared<Rhombus<double>>(4.0, 5.0, 0.0, 0.0));
+    figures.push_back(make_shared<Rhombus<double>>(6.0, 8.0, 0.0, 0.0));
+
+    CowArray<shared_ptr<Figure<double>>> live(std::move(figures));
+    const CowArray<shared_ptr<Figure<double>>> report = live;
+    EXPECT_DOUBLE_EQ(calculateTotalArea(report), 34.0);
+
+    live.push_back(make_shared<Rhombus<double>>(2.0, 2.0, 0.0, 0.0));
+    EXPECT_DOUBLE_EQ(calculateTotalArea(live), 36.0);
+    EXPECT_DOUBLE_EQ(calculateTotalArea(report.array()), 34.0);
+
+    CowArray<shared_ptr<Figure<double>>> moved = std::move(live);
+    EXPECT_EQ(moved.size(), 3);
+    EXPECT_EQ(live.size(), 0);
+    live.push_back(make_shared<Rhombus<double>>(2.0, 2.0, 0.0, 0.0));
+    EXPECT_EQ(live.size(), 1);
+}
+
+TEST(test_75, ArrayBulkRemoval) {
+    Array<int> arr = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    arr.swap_remove(1);
+    EXPECT_EQ(arr.size(), 7);
+    EXPECT_EQ(arr[1], 8);
+
+    arr.erase(2, 4);
+    EXPECT_EQ(arr.size(), 5);
+    EXPECT_EQ(arr[2], 5);
+    EXPECT_THROW(arr.erase(3, 6), std::out_of_range);
+    EXPECT_THROW(arr.swap_remove(5), std::out_of_range);
+
+    size_t removed = arr.erase_if([](int value) { return value % 2 == 0; });
+    EXPECT_EQ(removed, 2);
+    EXPECT_EQ(arr.size(), 3);
+    EXPECT_EQ(arr[0], 1);
+    EXPECT_EQ(arr[1], 5);
+    EXPECT_EQ(arr[2], 7);
+}
+
+TEST(test_76, PruneFiguresByArea) {
+    Array<shared_ptr<Figure<double>>> figures;
+    for (int i = 1; i <= 10; ++i) {
+        figures.push_back(make_shared<Rhombus<double>>(i, 2.0, 0.0, 0.0));
+    }
+    EXPECT_EQ(removeFiguresBelowArea(figures, 5.0), 4);
+    EXPECT_EQ(figures.size(), 6);
+    EXPECT_DOUBLE_EQ(figures[0]->calculateArea(), 5.0);
+
+    SmallArray<int, 4> small = {1, 2, 3, 4, 5};
+    small.erase(0, 2);
+    EXPECT_EQ(small[0], 3);
+    small.erase_if([](int value) { return value > 3; });
+    EXPECT_EQ(small.size(), 1);
+
+    CowArray<int> cow = {1, 2, 3};
+    CowArray<int> snapshot = cow;
+    cow.swap_remove(0);
+    EXPECT_EQ(std::as_const(cow)[0], 3);
+    EXPECT_EQ(snapshot.size(), 3);
+}
+
+TEST(test_77, ParallelTotalAreaIsDeterministic) {
+    Array<shared_ptr<Figure<double>>> figures;
+    for (int i = 0; i < 20000; ++i) {
+        double size = 0.1 + (i * 7919 % 1000) * 0.37;
+        if (i % 3 == 0) {
+            figures.push_back(make_shared<Rhombus<double>>(size, size * 0.5, 0.0, 0.0));
+        } else if (i % 3 == 1) {
+            figures.push_back(make_shared<Pentagon<double>>(size, 0.0, 0.0));
+        } else {
+            figures.push_back(make_shared<Hexagon<double>>(size, 0.0, 0.0));
+        }
+    }
+
+    double reference = calculateTotalAreaParallel(figures, 1);
+    for (unsigned threads : {2u, 3u, 4u, 7u, 16u}) {
+        EXPECT_EQ(calculateTotalAreaParallel(figures, threads), reference);
+    }
+    EXPECT_NEAR(reference, calculateTotalArea(figures), reference * 1e-12);
+
+    Array<shared_ptr<Figure<double>>> empty;
+    EXPECT_DOUBLE_EQ(calculateTotalAreaParallel(empty, 4), 0.0);
+}
+
+static Array<shared_ptr<Figure<double>>> makeScatteredFigures(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> position(-100.0, 100.0);
+    std::uniform_real_distribution<double> size(0.5, 4.0);
+    Array<shared_ptr<Figure<double>>> figures;
+    for (size_t i = 0; i < n; ++i) {
+        double x = position(rng), y = position(rng);
+        switch (i % 3) {
+            case 0: figures.push_back(make_shared<Rhombus<double>>(size(rng), size(rng), x, y)); break;
+            case 1: figures.push_back(make_shared<Pentagon<double>>(size(rng), x, y)); break;
+            default: figures.push_back(make_shared<Hexagon<double>>(size(rng), x, y)); break;
+        }
+    }
+    return figures;
+}
+
+TEST(test_78, SpatialGridRangeAndPointQueries) {
+    auto figures = makeScatteredFigures(500, 42);
+    SpatialGrid<double> grid(figures);
+    EXPECT_EQ(grid.size(), 500);
+
+    BoundingBox range{-20.0, -35.0, 15.0, 10.0};
+    auto found = grid.queryRange(range);
+    std::sort(found.begin(), found.end());
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < figures.size(); ++i) {
+        if (figures[i]->boundingBox().intersects(range)) {
+            expected.push_back(i);
+        }
+    }
+    EXPECT_EQ(found, expected);
+
+    auto all = grid.queryRange(BoundingBox{-1e9, -1e9, 1e9, 1e9});
+    EXPECT_EQ(all.size(), 500);
+
+    Point<double> center = figures[7]->calculateCenter();
+    auto hits = grid.queryPoint(center.x(), center.y());
+    EXPECT_NE(std::find(hits.begin(), hits.end(), 7), hits.end());
+}
+
+TEST(test_79, SpatialGridNearestAndUpdates) {
+    auto figures = makeScatteredFigures(300, 7);
+    SpatialGrid<double> grid(figures);
+
+    auto distance = [&](size_t i, double x, double y) {
+        Point<double> c = figures[i]->calculateCenter();
+        return std::hypot(c.x() - x, c.y() - y);
+    };
+    std::vector<size_t> order(figures.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return distance(a, 3.0, -4.0) < distance(b, 3.0, -4.0); });
+
+    auto nearest = grid.nearestCenters(3.0, -4.0, 5);
+    ASSERT_EQ(nearest.size(), 5);
+    for (size_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(nearest[i], order[i]);
+    }
+
+    grid.remove(order[0]);
+    EXPECT_EQ(grid.size(), 299);
+    EXPECT_EQ(grid.nearestCenters(3.0, -4.0, 1)[0], order[1]);
+    EXPECT_THROW(grid.remove(order[0]), std::out_of_range);
+
+    size_t handle = grid.insert(make_shared<Hexagon<double>>(1.0, 3.0, -4.0));
+    EXPECT_EQ(grid.nearestCenters(3.0, -4.0, 1)[0], handle);
+    EXPECT_EQ(grid.nearestCenters(500.0, 500.0, 1000).size(), 300);
+
+    // A figure far larger than the cells goes on the oversize list instead
+    // of being linked into millions of cells, and every query still sees it.
+    Array<std::shared_ptr<Figure<double>>> small;
+    for (int i = 0; i < 1000; ++i) {
+        small.push_back(make_shared<Hexagon<double>>(1.0, 3.0 * (i % 40), 3.0 * (i / 40)));
+    }
+    SpatialGrid<double> mixed(small);
+    size_t huge = mixed.insert(make_shared<Hexagon<double>>(3e6, 1e6, 1e6));
+    size_t infinite = mixed.insert(make_shared<Rhombus<double>>(INFINITY, 1.0, 0.0, -50.0));
+    EXPECT_EQ(mixed.size(), 1002);
+    auto range = mixed.queryRange(BoundingBox{-0.5, -0.5, 0.5, 0.5});
+    std::sort(range.begin(), range.end());
+    EXPECT_EQ(range, (std::vector<size_t>{0, huge}));
+    auto point = mixed.queryPoint(0.0, 0.0);
+    std::sort(point.begin(), point.end());
+    EXPECT_EQ(point, (std::vector<size_t>{0, huge}));
+    EXPECT_EQ(mixed.queryPoint(-1e9, -50.0), (std::vector<size_t>{infinite}));
+    EXPECT_EQ(mixed.nearestCenters(1e6, 1e6, 1), std::vector<size_t>{huge});
+    EXPECT_EQ(mixed.nearestCenters(0.0, 0.0, 1003).size(), 1002);
+    mixed.remove(huge);
+    mixed.remove(infinite);
+    EXPECT_EQ(mixed.queryPoint(0.0, 0.0), std::vector<size_t>{0});
+    EXPECT_EQ(mixed.nearestCenters(1e6, 1e6, 1), std::vector<size_t>{999});
+
+    // A grid holding only oversize figures.
+    SpatialGrid<double> sparse(0.001);
+    size_t only = sparse.insert(make_shared<Hexagon<double>>(10.0, 0.0, 0.0));
+    EXPECT_EQ(sparse.nearestCenters(5.0, 5.0, 2), std::vector<size_t>{only});
+    EXPECT_EQ(sparse.queryRange(BoundingBox{-1.0, -1.0, 1.0, 1.0}), std::vector<size_t>{only});
+}
+
+TEST(test_80, ClosedFormBoundingBoxMatchesVertices) {
+    auto figures = makeScatteredFigures(60, 3);
+    figures.push_back(make_shared<Octagon<double>>(2.0, 1.0, 1.0));
+    for (const auto &figure : figures) {
+        BoundingBox fromVertices;
+        Point<double> vertices[Figure<double>::MAX_VERTICES];
+        size_t count = figure->writeVertices(vertices);
+        for (size_t i = 0; i < count; ++i) {
+            fromVertices.expand(vertices[i].x(), vertices[i].y());
+        }
+        BoundingBox box = figure->boundingBox();
+        EXPECT_NEAR(box.minX, fromVertices.minX, 1e-9);
+        EXPECT_NEAR(box.minY, fromVertices.minY, 1e-9);
+        EXPECT_NEAR(box.maxX, fromVertices.maxX, 1e-9);
+        EXPECT_NEAR(box.maxY, fromVertices.maxY, 1e-9);
+    }
+
+    // Integer vertices are truncated and the box follows them.
+    Rhombus<int> rhombus(5, 3, 0, 0);
+    EXPECT_EQ(rhombus.boundingBox(), (BoundingBox{-2.0, -1.0, 2.0, 1.0}));
+    Array<std::shared_ptr<Figure<int>>> integers;
+    integers.push_back(make_shared<Pentagon<int>>(1, -1, 0));
+    integers.push_back(make_shared<Hexagon<int>>(7, 3, -2));
+    integers.push_back(make_shared<Octagon<int>>(-5, 0, 4));
+    integers.push_back(make_shared<Rhombus<int>>(-7, 3, 1, 1));
+    for (const auto &figure : integers) {
+        BoundingBox fromVertices;
+        Point<int> vertices[Figure<int>::MAX_VERTICES];
+        size_t count = figure->writeVertices(vertices);
+        for (size_t i = 0; i < count; ++i) {
+            fromVertices.expand(vertices[i].x(), vertices[i].y());
+        }
+        EXPECT_EQ(figure->boundingBox(), fromVertices);
+    }
+    EXPECT_EQ(integers[0]->boundingBox().maxX, 0.0);
+
+    // Negative sizes give the same box as the mirrored positive figure.
+    Rhombus<double> negative(-4.0, -4.0, 0.0, 0.0);
+    EXPECT_EQ(negative.boundingBox(), Rhombus<double>(4.0, 4.0, 0.0, 0.0).boundingBox());
+    BoundingBox hexagon = Hexagon<double>(-2.0, 1.0, 1.0).boundingBox();
+    EXPECT_FALSE(hexagon.empty());
+    EXPECT_DOUBLE_EQ(hexagon.maxX - hexagon.minX, 4.0);
+    FigureStore<double> store;
+    store.addRhombus(-4.0, -4.0, 0.0, 0.0);
+    store.addHexagon(-2.0, 1.0, 1.0);
+    double flat[2 * BOUNDING_BOX_STRIDE];
+    store.writeBoundingBoxes(flat);
+    EXPECT_EQ((BoundingBox{flat[0], flat[1], flat[2], flat[3]}), negative.boundingBox());
+    EXPECT_EQ((BoundingBox{flat[4], flat[5], flat[6], flat[7]}), hexagon);
+
+    // "R -4 -4 0 0" parses and is found by the grid and the collection.
+    auto parsed = parseFigures<double>("R -4 -4 0 0\nH 1 10 10\n");
+    SpatialGrid<double> grid(parsed);
+    EXPECT_EQ(grid.queryPoint(0.5, 0.5), std::vector<size_t>{0});
+    EXPECT_EQ(grid.queryRange(BoundingBox{-1.0, -1.0, 1.0, 1.0}), std::vector<size_t>{0});
+    EXPECT_EQ(grid.nearestCenters(0.0, 0.0, 1), std::vector<size_t>{0});
+    FigureCollection<double> collection(parsed);
+    EXPECT_EQ(collection.extent().minX, -2.0);
+}
+
+TEST(test_81, BatchBoundingBoxKernels) {
+    auto figures = makeScatteredFigures(30, 11);
+    std::vector<double> flat(figures.size() * BOUNDING_BOX_STRIDE);
+    writeBoundingBoxes(figures, flat.data());
+    for (size_t i = 0; i < figures.size(); ++i) {
+        BoundingBox box = figures[i]->boundingBox();
+        EXPECT_EQ(flat[i * BOUNDING_BOX_STRIDE + 0], box.minX);
+        EXPECT_EQ(flat[i * BOUNDING_BOX_STRIDE + 3], box.maxY);
+    }
+
+    FigureStore<double> store;
+    store.addRhombus(4.0, 2.0, 1.0, 1.0);
+    store.addHexagon(1.0, 0.0, 0.0);
+    std::vector<double> columnar(store.size() * BOUNDING_BOX_STRIDE);
+    store.writeBoundingBoxes(columnar.data());
+    EXPECT_DOUBLE_EQ(columnar[0], -1.0);
+    EXPECT_DOUBLE_EQ(columnar[3], 2.0);
+    BoundingBox hexagonBox = Hexagon<double>(1.0, 0.0, 0.0).boundingBox();
+    EXPECT_DOUBLE_EQ(columnar[4], hexagonBox.minX);
+    EXPECT_DOUBLE_EQ(columnar[7], hexagonBox.maxY);
+}
+
+TEST(test_82, FigureFileRoundTrip) {
+    auto figures = makeScatteredFigures(101, 5);
+    std::string path = testing::TempDir() + "figures_roundtrip.figb";
+    writeFigureFile(path, figures);
+
+    MappedFigureFile<double> file(path);
+    EXPECT_EQ(file.size(), 101);
+    EXPECT_EQ(file.rhombusCount(), 34);
+    EXPECT_EQ(file.pentagonCount(), 34);
+    EXPECT_EQ(file.hexagonCount(), 33);
+    EXPECT_NEAR(file.totalArea(), calculateTotalArea(figures), 1e-9);
+
+    double iterated = 0.0;
+    size_t visited = 0;
+    file.forEachFigure([&](const Figure<double> &figure) {
+        iterated += figure.calculateArea();
+        ++visited;
+    });
+    EXPECT_EQ(visited, 101);
+    EXPECT_NEAR(iterated, calculateTotalArea(figures), 1e-9);
+
+    auto loaded = file.toArray();
+    ASSERT_EQ(loaded.size(), figures.size());
+    for (size_t i = 0; i < loaded.size(); ++i) {
+        bool found = false;
+        for (size_t j = 0; j < figures.size() && !found; ++j) {
+            found = loaded[i]->isEqual(*figures[j]);
+        }
+        EXPECT_TRUE(found);
+    }
+    EXPECT_EQ(file.toStore().size(), 101);
+}
+
+TEST(test_83, FigureFileRejectsBadInput) {
+    Array<shared_ptr<Figure<int>>> figures;
+    figures.push_back(make_shared<Rhombus<int>>(4, 6, 1, 2));
+    std::string path = testing::TempDir() + "figures_int.figb";
+    writeFigureFile(path, figures);
+
+    MappedFigureFile<int> file(path);
+    EXPECT_DOUBLE_EQ(file.totalArea(), 12.0);
+    EXPECT_EQ(file.rhombuses()[0].x, 1);
+    EXPECT_THROW(MappedFigureFile<double>{path}, std::runtime_error);
+
+    std::string garbage = testing::TempDir() + "figures_garbage.figb";
+    {
+        std::ofstream os(garbage, std::ios::binary);
+        os << "definitely not a figure file, but long enough to hold a header......";
+    }
+    EXPECT_THROW(MappedFigureFile<int>{garbage}, std::runtime_error);
+    EXPECT_THROW(MappedFigureFile<int>{testing::TempDir() + "missing.figb"}, std::runtime_error);
+}
+
+TEST(test_84, BulkFigureParser) {
+    const char *text =
+        "# scene\n"
+        "R 4 5 0 0\n"
+        "\n"
+        "P\t1.5 -2 3.25\r\n"
+        "  H 2 1e1 -0.5";
+    auto figures = parseFigures<double>(text);
+    ASSERT_EQ(figures.size(), 3);
+    EXPECT_TRUE(figures[0]->isEqual(Rhombus<double>(4.0, 5.0, 0.0, 0.0)));
+    EXPECT_TRUE(figures[1]->isEqual(Pentagon<double>(1.5, -2.0, 3.25)));
+    EXPECT_TRUE(figures[2]->isEqual(Hexagon<double>(2.0, 10.0, -0.5)));
+
+    auto store = parseFigureStore<int>("R 6 8 1 1\nH 3 0 0\n");
+    EXPECT_EQ(store.rhombusCount(), 1);
+    EXPECT_EQ(store.hexagonCount(), 1);
+    EXPECT_DOUBLE_EQ(store.rhombusArea(), 24.0);
+
+    std::istringstream is("P 2 0 0\nP 3 0 0\n");
+    EXPECT_EQ(parseFigures<float>(is).size(), 2);
+
+    // Each parsed figure is owned on its own, like every other producer.
+    shared_ptr<Figure<double>> kept = figures[1];
+    EXPECT_EQ(kept.use_count(), 2);
+    figures.clear();
+    EXPECT_EQ(kept.use_count(), 1);
+    EXPECT_TRUE(kept->isEqual(Pentagon<double>(1.5, -2.0, 3.25)));
+
+    // The short-decimal fast path gives exactly what from_chars gives.
+    std::vector<std::string> samples = {"0", "-0", ".5", "5.", "-12.375", "0.1", "123456789012345",
+                                        "1234567890123456", "9007199254740993", "1e3", "-", ".", "inf", "nan"};
+    std::mt19937 rng(9);
+    for (int i = 0; i < 20000; ++i) {
+        std::string digits = std::to_string(rng() % 100000000);
+        size_t point = rng() % (digits.size() + 1);
+        samples.push_back((rng() % 2 ? "-" : "") + digits.substr(0, point) + "." + digits.substr(point));
+    }
+    for (const std::string &sample : samples) {
+        double fast = 0.0, reference = 0.0;
+        auto fast_result = parseNumber(sample.data(), sample.data() + sample.size(), fast);
+        auto reference_result = std::from_chars(sample.data(), sample.data() + sample.size(), reference);
+        ASSERT_EQ(fast_result.ec, reference_result.ec) << sample;
+        if (reference_result.ec == std::errc()) {
+            EXPECT_EQ(fast_result.ptr, reference_result.ptr) << sample;
+            EXPECT_TRUE(std::memcmp(&fast, &reference, sizeof(double)) == 0 || (std::isnan(fast) && std::isnan(reference))) << sample;
+        }
+    }
+}
+
+TEST(test_85, BulkFigureParserReportsLine) {
+    auto lineOf = [](const char *text) -> size_t {
+        try {
+            parseFigures<double>(text);
+        } catch (const FigureParseError &error) {
+            return error.line();
+        }
+        return 0;
+    };
+    EXPECT_EQ(lineOf("R 1 2 3 4\nX 1 2 3\n"), 2);
+    EXPECT_EQ(lineOf("R 1 2 3 4\n\nP 1 2\n"), 3);
+    EXPECT_EQ(lineOf("H 1 2 abc\n"), 1);
+    EXPECT_EQ(lineOf("H 1 2 3 4\n"), 1);
+    EXPECT_EQ(lineOf("HX 1 2 3\n"), 1);
+    EXPECT_EQ(lineOf("P 1 2 3\n"), 0);
+    EXPECT_THROW(parseFigures<int>("R 1.5 2 3 4"), FigureParseError);
+}
+
+TEST(test_86, FigureWriterTextMatchesOperator) {
+    Array<shared_ptr<Figure<double>>> figures;
+    figures.push_back(make_shared<Rhombus<double>>(4.0, 3.0, 0.1, -2.0));
+    figures.push_back(make_shared<Pentagon<double>>(1.0 / 3.0, 1e7, 2.5));
+    figures.push_back(make_shared<Hexagon<double>>(12345.678, -0.0, 1e-5));
+    std::ostringstream expected;
+    for (const auto &figure : figures) {
+        expected << *figure;
+    }
+
+    std::ostringstream bulk;
+    exportFigures(bulk, figures);
+    EXPECT_EQ(bulk.str(), expected.str());
+
+    // A buffer smaller than the output forces several flushes.
+    std::ostringstream chunked;
+    {
+        FigureWriter writer(chunked, ExportFormat::TEXT, 1);
+        for (int i = 0; i < 20; ++i) {
+            writer.write(figures);
+        }
+        EXPECT_EQ(writer.figuresWritten(), 60);
+    }
+    std::string repeated;
+    for (int i = 0; i < 20; ++i) {
+        repeated += expected.str();
+    }
+    EXPECT_EQ(chunked.str(), repeated);
+
+    std::ostringstream ints;
+    exportFigures(ints, parseFigures<int>("R 4 6 -1 2\n"));
+    std::ostringstream int_expected;
+    int_expected << Rhombus<int>(4, 6, -1, 2);
+    EXPECT_EQ(ints.str(), int_expected.str());
+}
+
+TEST(test_87, FigureWriterCsvAndJsonLines) {
+    Array<shared_ptr<Figure<double>>> figures;
+    figures.push_back(make_shared<Rhombus<double>>(2.0, 4.0, 0.1, 0.0));
+    figures.push_back(make_shared<Hexagon<double>>(1.0, 0.0, 0.0));
+
+    std::ostringstream csv;
+    exportFigures(csv, figures, ExportFormat::CSV);
+    std::istringstream rows(csv.str());
+    std::string line;
+    std::getline(rows, line);
+    EXPECT_EQ(line, "figure,kind,vertex,x,y");
+    std::getline(rows, line);
+    EXPECT_EQ(line, "0,rhombus,0,0.1,2");
+    size_t count = 1;
+    std::string last;
+    while (std::getline(rows, line)) {
+        last = line;
+        ++count;
+    }
+    EXPECT_EQ(count, 10);
+    EXPECT_EQ(last.rfind("1,hexagon,5,", 0), 0);
+
+    std::ostringstream json;
+    exportFigures(json, figures, ExportFormat::JSON_LINES);
+    std::istringstream objects(json.str());
+    std::getline(objects, line);
+    EXPECT_EQ(line, "{\"kind\":\"rhombus\",\"vertices\":[[0.1,2],[1.1,0],[0.1,-2],[-0.9,0]]}");
+    std::getline(objects, line);
+    EXPECT_EQ(line.rfind("{\"kind\":\"hexagon\",\"vertices\":[[", 0), 0);
+    EXPECT_EQ(std::count(line.begin(), line.end(), '['), 7);
+    EXPECT_FALSE(std::getline(objects, line));
+
+    std::ostringstream nan_json;
+    FigureWriter writer(nan_json, ExportFormat::JSON_LINES);
+    writer.write(Rhombus<double>(NAN, 2.0, 0.0, 0.0));
+    writer.flush();
+    EXPECT_EQ(nan_json.str(), "{\"kind\":\"rhombus\",\"vertices\":[[0,1],[null,0],[0,-1],[null,0]]}\n");
+}
+
+#ifdef ARRAY_STATS
+TEST(test_88, ArrayStatsCountGrowthAndCopies) {
+    globalArrayStats().reset();
+    Array<int> values;
+    for (int i = 0; i < 5; ++i) {
+        values.push_back(i);
+    }
+    ArrayStats stats = values.stats();
+    EXPECT_EQ(stats.allocations, 4);
+    EXPECT_EQ(stats.reallocations, 3);
+    EXPECT_EQ(stats.elementMoves, 1 + 2 + 4);
+    EXPECT_EQ(stats.allocatedBytes, (1 + 2 + 4 + 8) * sizeof(int));
+    EXPECT_EQ(stats.peakBytes, 8 * sizeof(int));
+    EXPECT_EQ(stats.wastedBytes, 3 * sizeof(int));
+
+    Array<int> copy(values);
+    EXPECT_EQ(copy.stats().elementCopies, 5);
+    EXPECT_EQ(copy.stats().allocations, 1);
+    copy.remove(0);
+    EXPECT_EQ(copy.stats().elementMoves, 4);
+
+    Array<int> moved(std::move(values));
+    EXPECT_EQ(moved.stats().reallocations, 3);
+    EXPECT_EQ(values.stats().allocations, 0);
+    Array<int> assigned;
+    assigned.push_back(1);
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.stats().reallocations, 3);
+    EXPECT_EQ(assigned.stats().allocations, 5);
+    EXPECT_EQ(moved.stats().allocations, 0);
+    EXPECT_EQ(moved.stats().reallocations, 0);
+    assigned.resetStats();
+    EXPECT_EQ(assigned.stats().allocations, 0);
+
+    ArrayStats global = globalArrayStats().snapshot();
+    EXPECT_EQ(global.allocations, 6);
+    EXPECT_EQ(global.elementCopies, 5);
+    EXPECT_EQ(global.elementMoves, 7 + 4);
+    // Buffers of 1, 2 and 4 ints were freed full during growth.
+    EXPECT_EQ(global.wastedBytes, 0);
+}
+
+TEST(test_89, ArrayStatsReserveAvoidsReallocation) {
+    globalArrayStats().reset();
+    {
+        Array<shared_ptr<Figure<double>>> figures;
+        figures.reserve(100);
+        for (int i = 0; i < 100; ++i) {
+            figures.push_back(make_shared<Hexagon<double>>(1.0, 0.0, 0.0));
+        }
+        EXPECT_EQ(figures.stats().reallocations, 0);
+        EXPECT_EQ(figures.stats().elementMoves, 0);
+        figures.erase_if([](const auto &) { return true; });
+        EXPECT_EQ(figures.stats().wastedBytes, 100 * sizeof(shared_ptr<Figure<double>>));
+    }
+    EXPECT_EQ(globalArrayStats().snapshot().wastedBytes, 100 * sizeof(shared_ptr<Figure<double>>));
+}
+#endif
+
+TEST(test_90, RankFiguresByArea) {
+    auto figures = makeScatteredFigures(2000, 11);
+    figures.push_back(make_shared<Rhombus<double>>(2.0, 2.0, 0.0, 0.0));
+    figures.push_back(make_shared<Rhombus<double>>(2.0, 2.0, 5.0, 5.0));
+
+    std::vector<size_t> expected(figures.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        expected[i] = i;
+    }
+    std::stable_sort(expected.begin(), expected.end(), [&](size_t a, size_t b) {
+        return figures[a]->calculateArea() < figures[b]->calculateArea();
+    });
+
+    auto sorted = sortedByArea(figures);
+    ASSERT_EQ(sorted.size(), figures.size());
+    EXPECT_TRUE(std::equal(sorted.begin(), sorted.end(), expected.begin()));
+
+    auto largest = largestByArea(figures, 10);
+    ASSERT_EQ(largest.size(), 10);
+    for (size_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(figures[largest[i]]->calculateArea(), figures[expected[expected.size() - 1 - i]]->calculateArea());
+    }
+    EXPECT_EQ(largestByArea(figures, 5000).size(), figures.size());
+    EXPECT_TRUE(largestByArea(figures, 0, 1).empty());
+    EXPECT_TRUE(nearestByCenter(figures, 0.0, 0.0, 0, 1).empty());
+    EXPECT_EQ(nthByArea(figures, 0), expected.front());
+    EXPECT_EQ(nthByArea(figures, 1000), expected[1000]);
+    EXPECT_THROW(nthByArea(figures, figures.size()), std::out_of_range);
+
+    auto top = gatherFigures(figures, largest);
+    EXPECT_EQ(top[0], figures[largest[0]]);
+}
+
+TEST(test_91, RankFiguresByCenterDistanceInParallel) {
+    auto figures = makeScatteredFigures(100000, 5);
+    auto serial = sortedByCenterDistance(figures, 10.0, -20.0, 1);
+    auto parallel = sortedByCenterDistance(figures, 10.0, -20.0, 4);
+    ASSERT_EQ(serial.size(), figures.size());
+    EXPECT_TRUE(std::equal(serial.begin(), serial.end(), parallel.begin()));
+
+    auto distance = [&](size_t i) {
+        Point<double> center = figures[i]->calculateCenter();
+        double dx = center.x() - 10.0, dy = center.y() + 20.0;
+        return dx * dx + dy * dy;
+    };
+    for (size_t i = 1; i < serial.size(); ++i) {
+        ASSERT_LE(distance(serial[i - 1]), distance(serial[i]));
+    }
+    auto nearest = nearestByCenter(figures, 10.0, -20.0, 25, 4);
+    EXPECT_TRUE(std::equal(nearest.begin(), nearest.end(), serial.begin()));
+
+    std::vector<int> values(100003);
+    std::mt19937 rng(3);
+    for (int &value : values) {
+        value = static_cast<int>(rng() % 1000);
+    }
+    auto reference = values;
+    std::sort(reference.begin(), reference.end());
+    parallelSort(values.data(), values.size(), 3, std::less<int>());
+    EXPECT_EQ(values, reference);
+}
+
+TEST(test_92, CachedFigureMatchesFreshComputation) {
+    CachedFigure<Hexagon<double>> hexagon(2.5, 1.0, -3.0);
+    Hexagon<double> plain(2.5, 1.0, -3.0);
+    EXPECT_FALSE(hexagon.isCached());
+    EXPECT_EQ(hexagon.calculateArea(), plain.calculateArea());
+    EXPECT_TRUE(hexagon.isCached());
+    EXPECT_EQ(hexagon.calculateArea(), plain.calculateArea());
+    auto cached_vertices = hexagon.getVertices();
+    auto plain_vertices = plain.getVertices();
+    ASSERT_EQ(cached_vertices.size(), plain_vertices.size());
+    for (size_t i = 0; i < plain_vertices.size(); ++i) {
+        EXPECT_EQ(*cached_vertices[i], *plain_vertices[i]);
+    }
+    std::ostringstream cached_text, plain_text;
+    cached_text << hexagon;
+    plain_text << plain;
+    EXPECT_EQ(cached_text.str(), plain_text.str());
+    EXPECT_TRUE(hexagon.isEqual(plain));
+
+    Array<shared_ptr<Figure<double>>> figures;
+    figures.push_back(make_shared<CachedFigure<Rhombus<double>>>(4.0, 6.0, 0.0, 0.0));
+    figures.push_back(make_shared<CachedFigure<Pentagon<double>>>(1.0, 0.0, 0.0));
+    EXPECT_DOUBLE_EQ(calculateTotalArea(figures), 12.0 + Pentagon<double>(1.0, 0.0, 0.0).calculateArea());
+    EXPECT_LE(sizeof(Hexagon<double>), sizeof(CachedFigure<Hexagon<double>>));
+}
+
+TEST(test_93, CachedFigureInvalidatesOnMutation) {
+    CachedFigure<Rhombus<int>> rhombus(4, 6, 0, 0);
+    EXPECT_EQ(rhombus.calculateArea(), 12.0);
+
+    std::istringstream is("10 2 1 1");
+    is >> rhombus;
+    EXPECT_FALSE(rhombus.isCached());
+    EXPECT_EQ(rhombus.calculateArea(), 10.0);
+    EXPECT_EQ(rhombus.vertices()[0], Point<int>(1, 2));
+
+    rhombus = Rhombus<int>(2, 2, 0, 0);
+    EXPECT_EQ(rhombus.calculateArea(), 2.0);
+
+    CachedFigure<Rhombus<int>> other(8, 8, 0, 0);
+    other.calculateArea();
+    rhombus = other;
+    EXPECT_EQ(rhombus.calculateArea(), 32.0);
+
+    CachedFigure<Rhombus<int>> moved(std::move(other));
+    EXPECT_EQ(moved.calculateArea(), 32.0);
+    EXPECT_FALSE(other.isCached());
+
+    rhombus = Rhombus<int>(1, 1, 0, 0);
+    rhombus.calculateArea();
+    rhombus = std::move(moved);
+    EXPECT_EQ(rhombus.calculateArea(), 32.0);
+    EXPECT_FALSE(moved.isCached());
+}
+
+TEST(test_94, FigureHashAgreesWithEquality) {
+    std::hash<Point<double>> point_hash;
+    EXPECT_EQ(point_hash(Point<double>(0.0, 1.5)), point_hash(Point<double>(-0.0, 1.5)));
+    EXPECT_NE(point_hash(Point<double>(1.0, 2.0)), point_hash(Point<double>(2.0, 1.0)));
+
+    Rhombus<double> rhombus(4.0, 6.0, -0.0, 1.0);
+    EXPECT_TRUE(rhombus.isEqual(Rhombus<double>(4.0, 6.0, 0.0, 1.0)));
+    EXPECT_EQ(std::hash<Rhombus<double>>()(rhombus), std::hash<Rhombus<double>>()(Rhombus<double>(4.0, 6.0, 0.0, 1.0)));
+    EXPECT_EQ(std::hash<Pentagon<int>>()(Pentagon<int>(3, 1, 2)), Pentagon<int>(3, 1, 2).hashValue());
+    EXPECT_NE(std::hash<Hexagon<int>>()(Hexagon<int>(3, 1, 2)), std::hash<Hexagon<int>>()(Hexagon<int>(3, 1, 3)));
+
+    CachedFigure<Hexagon<double>> cached(2.0, 0.0, 0.0);
+    const Figure<double> &plain = Hexagon<double>(2.0, 0.0, 0.0);
+    EXPECT_TRUE(cached.isEqual(plain));
+    EXPECT_EQ(cached.hashValue(), plain.hashValue());
+
+    std::unordered_set<Hexagon<double>> set;
+    set.insert(Hexagon<double>(1.0, 0.0, 0.0));
+    set.insert(Hexagon<double>(1.0, -0.0, 0.0));
+    EXPECT_EQ(set.size(), 1);
+}
+
+TEST(test_95, DeduplicateAndGroupFigures) {
+    Array<shared_ptr<Figure<int>>> figures;
+    figures.push_back(make_shared<Rhombus<int>>(2, 2, 0, 0));
+    figures.push_back(make_shared<Hexagon<int>>(3, 1, 1));
+    figures.push_back(make_shared<Rhombus<int>>(2, 2, 0, 0));
+    figures.push_back(make_shared<Pentagon<int>>(3, 1, 1));
+    figures.push_back(make_shared<Hexagon<int>>(3, 1, 1));
+    figures.push_back(make_shared<Rhombus<int>>(2, 4, 0, 0));
+
+    auto kinds = groupByKind(figures);
+    ASSERT_EQ(kinds.size(), 3);
+    EXPECT_EQ(std::vector<size_t>(kinds[0].begin(), kinds[0].end()), (std::vector<size_t>{0, 2, 5}));
+    EXPECT_EQ(std::vector<size_t>(kinds[1].begin(), kinds[1].end()), (std::vector<size_t>{1, 4}));
+    EXPECT_EQ(std::vector<size_t>(kinds[2].begin(), kinds[2].end()), (std::vector<size_t>{3}));
+
+    auto groups = groupByParameters(figures);
+    ASSERT_EQ(groups.size(), 4);
+    EXPECT_EQ(std::vector<size_t>(groups[0].begin(), groups[0].end()), (std::vector<size_t>{0, 2}));
+    EXPECT_EQ(std::vector<size_t>(groups[1].begin(), groups[1].end()), (std::vector<size_t>{1, 4}));
+
+    auto keep = figures[3];
+    EXPECT_EQ(removeDuplicateFigures(figures), 2);
+    ASSERT_EQ(figures.size(), 4);
+    EXPECT_EQ(figures[2], keep);
+    EXPECT_EQ(removeDuplicateFigures(figures), 0);
+
+    auto scattered = makeScatteredFigures(3000, 9);
+    for (size_t i = 0; i < 1000; ++i) {
+        scattered.push_back(scattered[i * 3]);
+    }
+    EXPECT_EQ(removeDuplicateFigures(scattered), 1000);
+    EXPECT_EQ(scattered.size(), 3000);
+}
+
+TEST(test_96, FigureTransforms) {
+    Rhombus<int> rhombus(4, 2, 3, 1);
+    rhombus.translate(-3, 2);
+    EXPECT_EQ(rhombus, Rhombus<int>(4, 2, 0, 3));
+    rhombus.scale(3, 0, 1);
+    EXPECT_EQ(rhombus, Rhombus<int>(12, 6, 0, 7));
+    EXPECT_TRUE(rhombus.rotateQuarterTurns(1, 0, 0));
+    EXPECT_EQ(rhombus, Rhombus<int>(6, 12, -7, 0));
+
+    // Rotating the figure turns its vertex set the same way.
+    Rhombus<int> original(4, 2, 3, 1);
+    Rhombus<int> turned = original;
+    turned.rotateQuarterTurns(-1, 1, 1);
+    std::vector<std::pair<int, int>> expected, actual;
+    for (auto vertex : original.vertices()) {
+        vertex.rotateQuarterTurns(3, 1, 1);
+        expected.emplace_back(vertex.x(), vertex.y());
+    }
+    for (const auto &vertex : turned.vertices()) {
+        actual.emplace_back(vertex.x(), vertex.y());
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    EXPECT_EQ(actual, expected);
+
+    Hexagon<double> hexagon(2.0, 1.0, 1.0);
+    EXPECT_FALSE(hexagon.rotateQuarterTurns(1, 0.0, 0.0));
+    EXPECT_EQ(hexagon, Hexagon<double>(2.0, 1.0, 1.0));
+    EXPECT_TRUE(hexagon.rotateQuarterTurns(2, 0.0, 0.0));
+    EXPECT_EQ(hexagon, Hexagon<double>(2.0, -1.0, -1.0));
+    Pentagon<double> pentagon(1.0, 0.0, 0.0);
+    EXPECT_FALSE(pentagon.canRotateQuarterTurns(2));
+    EXPECT_TRUE(pentagon.canRotateQuarterTurns(-4));
+    EXPECT_TRUE(Octagon<double>(1.0, 0.0, 0.0).canRotateQuarterTurns(1));
+
+    CachedFigure<Hexagon<double>> cached(1.0, 0.0, 0.0);
+    double area = cached.calculateArea();
+    cached.scale(2.0, 0.0, 0.0);
+    EXPECT_DOUBLE_EQ(cached.calculateArea(), 4.0 * area);
+    cached.translate(1.0, 0.0);
+    EXPECT_EQ(cached.vertices()[0], Hexagon<double>(2.0, 1.0, 0.0).vertices()[0]);
+
+    // Negative factors are rejected and leave the figure as it was.
+    EXPECT_THROW(rhombus.scale(-1, 0, 0), std::invalid_argument);
+    EXPECT_EQ(rhombus, Rhombus<int>(6, 12, -7, 0));
+    EXPECT_THROW(hexagon.scale(-2.0, 0.0, 0.0), std::invalid_argument);
+    EXPECT_FALSE(hexagon.boundingBox().empty());
+    EXPECT_THROW(cached.scale(-0.5, 0.0, 0.0), std::invalid_argument);
+    EXPECT_DOUBLE_EQ(cached.calculateArea(), 4.0 * area);
+    rhombus.scale(0, 0, 0);
+    EXPECT_EQ(rhombus, Rhombus<int>(0, 0, 0, 0));
+}
+
+TEST(test_97, BatchTransformsMatchColumnarStore) {
+    auto figures = makeScatteredFigures(300, 21);
+    FigureStore<double> store(figures);
+
+    translateFigures(figures, 1.5, -2.0);
+    scaleFigures(figures, 2.0, 10.0, 10.0);
+    store.translate(1.5, -2.0);
+    store.scale(2.0, 10.0, 10.0);
+    EXPECT_FALSE(rotateFiguresQuarterTurns(figures, 1, 0.0, 0.0));
+    EXPECT_FALSE(store.rotateQuarterTurns(1, 0.0, 0.0));
+    EXPECT_TRUE(rotateFiguresQuarterTurns(figures, 4, 0.0, 0.0));
+    EXPECT_TRUE(store.rotateQuarterTurns(4, 0.0, 0.0));
+
+    FigureStore<double> expected(figures);
+    EXPECT_TRUE(std::equal(store.rhombuses().x.begin(), store.rhombuses().x.end(), expected.rhombuses().x.begin()));
+    EXPECT_TRUE(std::equal(store.hexagons().y.begin(), store.hexagons().y.end(), expected.hexagons().y.begin()));
+    EXPECT_TRUE(std::equal(store.pentagons().side.begin(), store.pentagons().side.end(), expected.pentagons().side.begin()));
+    EXPECT_NEAR(store.totalArea(), calculateTotalArea(figures), 1e-9 * store.totalArea());
+
+    EXPECT_THROW(scaleFigures(figures, -1.0, 0.0, 0.0), std::invalid_argument);
+    EXPECT_THROW(store.scale(-1.0, 0.0, 0.0), std::invalid_argument);
+    EXPECT_EQ(store.rhombuses().diagonal1[0], expected.rhombuses().diagonal1[0]);
+
+    FigureStore<int> rhombuses;
+    rhombuses.addRhombus(2, 4, 1, 0);
+    EXPECT_TRUE(rhombuses.rotateQuarterTurns(3, 0, 0));
+    EXPECT_EQ(rhombuses.rhombuses().diagonal1[0], 4);
+    EXPECT_EQ(rhombuses.rhombuses().x[0], 0);
+    EXPECT_EQ(rhombuses.rhombuses().y[0], -1);
+}
+
+TEST(test_98, TriviallyRelocatableTypes) {
+    static_assert(std::is_trivially_copyable_v<Point<double>>);
+    static_assert(is_trivially_relocatable_v<Point<int>>);
+    static_assert(is_trivially_relocatable_v<Rhombus<double>>);
+    static_assert(is_trivially_relocatable_v<Hexagon<float>>);
+    static_assert(is_trivially_relocatable_v<shared_ptr<Figure<double>>>);
+    static_assert(is_trivially_relocatable_v<std::unique_ptr<int>>);
+    static_assert(!is_trivially_relocatable_v<std::string>);
+
+    Array<Rhombus<double>> shapes;
+    for (int i = 0; i < 100; ++i) {
+        shapes.emplace_back(1.0 + i, 2.0, static_cast<double>(i), 0.0);
+    }
+    shapes.remove(0);
+    shapes.swap_remove(0);
+    shapes.erase(10, 20);
+    EXPECT_EQ(shapes.erase_if([](const Rhombus<double> &r) { return r.getDiagonal1() > 90.0; }), 10);
+    ASSERT_EQ(shapes.size(), 78);
+    EXPECT_EQ(shapes[0], Rhombus<double>(3.0, 2.0, 2.0, 0.0));
+    EXPECT_EQ(shapes[8], Rhombus<double>(11.0, 2.0, 10.0, 0.0));
+    EXPECT_EQ(shapes[9], Rhombus<double>(22.0, 2.0, 21.0, 0.0));
+    EXPECT_DOUBLE_EQ(shapes[77].calculateArea(), 90.0);
+
+    Array<Point<int>> points{Point<int>(1, 2), Point<int>(3, 4), Point<int>(5, 6)};
+    Array<Point<int>> target;
+    target.reserve(8);
+    target = points;
+    EXPECT_EQ(target.capacity(), 8);
+    EXPECT_EQ(target[2], Point<int>(5, 6));
+}
+
+TEST(test_99, RelocationKeepsOwnershipCounts) {
+    auto figure = make_shared<Hexagon<double>>(1.0, 0.0, 0.0);
+    {
+        Array<shared_ptr<Figure<double>>> figures;
+        for (int i = 0; i < 33; ++i) {
+            figures.push_back(figure);
+        }
+        EXPECT_EQ(figure.use_count(), 34);
+        figures.remove(3);
+        figures.swap_remove(0);
+        figures.erase(0, 5);
+        EXPECT_EQ(figure.use_count(), 27);
+
+        int calls = 0;
+        EXPECT_THROW(figures.erase_if([&calls](const shared_ptr<Figure<double>> &) {
+            if (++calls == 10) {
+                throw std::runtime_error("stop");
+            }
+            return calls % 2 == 0;
+        }), std::runtime_error);
+        EXPECT_EQ(figures.size(), 22);
+        EXPECT_EQ(figure.use_count(), 23);
+        for (const auto &item : figures) {
+            EXPECT_EQ(item, figure);
+        }
+    }
+    EXPECT_EQ(figure.use_count(), 1);
+}
+
+TEST(test_100, SeparatingAxisOverlap) {
+    Rhombus<double> diamond(2.0, 2.0, 0.0, 0.0);
+    // Bounding boxes overlap, the shapes do not.
+    EXPECT_FALSE(figuresOverlap<double>(diamond, Rhombus<double>(2.0, 2.0, 1.1, 1.1)));
+    EXPECT_TRUE(diamond.boundingBox().intersects(Rhombus<double>(2.0, 2.0, 1.1, 1.1).boundingBox()));
+    // Touching at a vertex counts as overlap.
+    EXPECT_TRUE(figuresOverlap<double>(diamond, Rhombus<double>(2.0, 2.0, 2.0, 0.0)));
+    EXPECT_FALSE(figuresOverlap<double>(diamond, Rhombus<double>(2.0, 2.0, 2.001, 0.0)));
+    // Containment.
+    EXPECT_TRUE(figuresOverlap<double>(Hexagon<double>(10.0, 0.0, 0.0), Pentagon<double>(0.1, 3.0, 3.0)));
+    EXPECT_TRUE(figuresOverlap<double>(Pentagon<double>(0.1, 3.0, 3.0), Hexagon<double>(10.0, 0.0, 0.0)));
+    EXPECT_TRUE(figuresOverlap<int>(Rhombus<int>(4, 4, 0, 0), Hexagon<int>(2, 3, 0)));
+
+    // Degenerate shapes: points, segments and repeated vertices.
+    EXPECT_FALSE(figuresOverlap<int>(Pentagon<int>(0, 0, 0), Pentagon<int>(0, 10, 10)));
+    EXPECT_TRUE(figuresOverlap<int>(Pentagon<int>(0, 3, 3), Pentagon<int>(0, 3, 3)));
+    EXPECT_FALSE(figuresOverlap<double>(Rhombus<double>(2.0, 0.0, 0.0, 0.0), Rhombus<double>(2.0, 0.0, 10.0, 0.0)));
+    EXPECT_TRUE(figuresOverlap<double>(Rhombus<double>(2.0, 0.0, 0.0, 0.0), Rhombus<double>(2.0, 0.0, 1.5, 0.0)));
+    EXPECT_TRUE(figuresOverlap<double>(Rhombus<double>(0.0, 2.0, 0.0, 0.0), Rhombus<double>(2.0, 0.0, 0.0, 0.0)));
+    EXPECT_FALSE(figuresOverlap<double>(Rhombus<double>(0.0, 0.0, 5.0, 5.0), Hexagon<double>(1.0, 0.0, 0.0)));
+    EXPECT_TRUE(figuresOverlap<double>(Rhombus<double>(0.0, 0.0, 0.5, 0.0), Hexagon<double>(1.0, 0.0, 0.0)));
+    // Collinear segments off the axes, apart along their common line.
+    Point<double> first[] = {{0.0, 0.0}, {1.0, 1.0}};
+    Point<double> second[] = {{2.0, 2.0}, {3.0, 3.0}};
+    Point<double> third[] = {{0.5, 0.5}, {3.0, 3.0}};
+    EXPECT_FALSE(convexPolygonsOverlap(first, 2, second, 2));
+    EXPECT_TRUE(convexPolygonsOverlap(first, 2, third, 2));
+}
+
+TEST(test_101, FindOverlappingPairsMatchesBruteForce) {
+    auto figures = makeScatteredFigures(1500, 17);
+    figures.push_back(make_shared<Hexagon<double>>(1.0, 500.0, 500.0));
+    figures.push_back(make_shared<Hexagon<double>>(1.0, 500.0, 500.0));
+
+    std::vector<OverlapPair> expected;
+    for (size_t i = 0; i < figures.size(); ++i) {
+        for (size_t j = i + 1; j < figures.size(); ++j) {
+            if (figuresOverlap(*figures[i], *figures[j])) {
+                expected.emplace_back(i, j);
+            }
+        }
+    }
+    ASSERT_GT(expected.size(), 100u);
+    EXPECT_EQ(expected.back(), OverlapPair(1500, 1501));
+
+    auto serial = findOverlappingPairs(figures, 1);
+    auto parallel = findOverlappingPairs(figures, 4);
+    EXPECT_EQ(std::vector<OverlapPair>(serial.begin(), serial.end()), expected);
+    EXPECT_EQ(std::vector<OverlapPair>(parallel.begin(), parallel.end()), expected);
+
+    Array<shared_ptr<Figure<double>>> empty;
+    EXPECT_TRUE(findOverlappingPairs(empty).empty());
+
+    // Integer vertices are truncated and can leave the closed-form box; the
+    // broad phase must still agree with figuresOverlap.
+    Array<shared_ptr<Figure<int>>> integers;
+    integers.push_back(make_shared<Pentagon<int>>(1, -1, 0));
+    integers.push_back(make_shared<Rhombus<int>>(2, 2, 1, 0));
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<int> position(-30, 30);
+    std::uniform_int_distribution<int> size(0, 4);
+    for (int i = 0; i < 600; ++i) {
+        switch (i % 3) {
+            case 0: integers.push_back(make_shared<Rhombus<int>>(size(rng), size(rng), position(rng), position(rng))); break;
+            case 1: integers.push_back(make_shared<Pentagon<int>>(size(rng), position(rng), position(rng))); break;
+            default: integers.push_back(make_shared<Hexagon<int>>(size(rng), position(rng), position(rng))); break;
+        }
+    }
+    std::vector<OverlapPair> expected_integers;
+    for (size_t i = 0; i < integers.size(); ++i) {
+        for (size_t j = i + 1; j < integers.size(); ++j) {
+            if (figuresOverlap(*integers[i], *integers[j])) {
+                expected_integers.emplace_back(i, j);
+            }
+        }
+    }
+    ASSERT_FALSE(expected_integers.empty());
+    EXPECT_EQ(expected_integers.front(), OverlapPair(0, 1));
+    auto integer_pairs = findOverlappingPairs(integers, 2);
+    EXPECT_EQ(std::vector<OverlapPair>(integer_pairs.begin(), integer_pairs.end()), expected_integers);
+}
+
+TEST(test_102, ShardedArrayConcurrentProducers) {
+    const size_t producers = 6;
+    const size_t per_producer = 5000;
+    ShardedArray<shared_ptr<Figure<double>>> collection(4);
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&collection, p] {
+            // Half the producers lock per element, the rest go through a Writer.
+            if (p % 2 == 0) {
+                for (size_t i = 0; i < per_producer; ++i) {
+                    collection.push_back(make_shared<Rhombus<double>>(2.0, static_cast<double>(i), static_cast<double>(p), 0.0));
+                }
+            } else {
+                auto writer = collection.writer(100);
+                for (size_t i = 0; i < per_producer; ++i) {
+                    writer.push_back(make_shared<Rhombus<double>>(2.0, static_cast<double>(i), static_cast<double>(p), 0.0));
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(collection.size(), producers * per_producer);
+
+    auto figures = collection.seal();
+    ASSERT_EQ(figures.size(), producers * per_producer);
+    EXPECT_EQ(collection.size(), 0u);
+    // Each producer's figures keep their relative order.
+    std::vector<double> last(producers, -1.0);
+    for (const auto &figure : figures) {
+        auto rhombus = std::dynamic_pointer_cast<Rhombus<double>>(figure);
+        size_t p = static_cast<size_t>(rhombus->calculateCenter().x());
+        EXPECT_GT(rhombus->calculateArea(), last[p]);
+        last[p] = rhombus->calculateArea();
+    }
+    // Area of diagonals 2 and i is i; summed over i < per_producer per producer.
+    double expected = static_cast<double>(producers) * static_cast<double>(per_producer * (per_producer - 1) / 2);
+    EXPECT_DOUBLE_EQ(calculateTotalArea(figures), expected);
+}
+
+TEST(test_103, ShardedArrayInlineShapesAndSeal) {
+    ShardedArray<FigureVariant<double>> collection(8);
+    EXPECT_EQ(collection.shardCount(), 8u);
+    EXPECT_TRUE(collection.seal().empty());
+    {
+        auto writer = collection.writer(3);
+        writer.emplace_back(Hexagon<double>(1.0, 0.0, 0.0));
+        writer.emplace_back(Rhombus<double>(2.0, 3.0, 0.0, 0.0));
+        writer.push_back(Pentagon<double>(1.0, 0.0, 0.0));
+        writer.emplace_back(Rhombus<double>(4.0, 4.0, 0.0, 0.0));
+        // The first three were flushed when the batch filled up.
+        EXPECT_EQ(collection.size(), 3u);
+    }
+    EXPECT_EQ(collection.size(), 4u);
+
+    // Everything came from one thread, so seal hands over that shard as is.
+    auto figures = collection.seal();
+    ASSERT_EQ(figures.size(), 4u);
+    EXPECT_TRUE(std::holds_alternative<Hexagon<double>>(figures[0]));
+    EXPECT_TRUE(std::holds_alternative<Rhombus<double>>(figures[3]));
+    double expected = Hexagon<double>(1.0, 0.0, 0.0).calculateArea() + 3.0
+        + Pentagon<double>(1.0, 0.0, 0.0).calculateArea() + 8.0;
+    EXPECT_NEAR(calculateTotalArea(figures), expected, 1e-12);
+    EXPECT_EQ(collection.size(), 0u);
+
+    collection.push_back(Hexagon<double>(2.0, 0.0, 0.0));
+    EXPECT_EQ(collection.seal().size(), 1u);
+
+    // Threads alive together get distinct slots, and fresh threads reuse
+    // the slots of finished ones instead of counting upwards.
+    for (int round = 0; round < 50; ++round) {
+        std::atomic<int> arrived{0};
+        size_t slots[3];
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 3; ++t) {
+            threads.emplace_back([&, t] {
+                slots[t] = liveThreadSlot();
+                ++arrived;
+                while (arrived.load() < 3) {
+                    std::this_thread::yield();
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        EXPECT_NE(slots[0], slots[1]);
+        EXPECT_NE(slots[0], slots[2]);
+        EXPECT_NE(slots[1], slots[2]);
+        EXPECT_LT(std::max({slots[0], slots[1], slots[2]}), 4u);
+    }
+
+    // The allocator reaches every shard, the writers and the sealed Array.
+    CountingResource resource;
+    using PmrVariant = std::pmr::polymorphic_allocator<FigureVariant<double>>;
+    ShardedArray<FigureVariant<double>, PmrVariant> pooled(4, PmrVariant(&resource));
+    {
+        auto writer = pooled.writer(2);
+        for (int i = 0; i < 5; ++i) {
+            writer.emplace_back(Hexagon<double>(1.0, 0.0, 0.0));
+        }
+    }
+    pooled.push_back(Pentagon<double>(1.0, 0.0, 0.0));
+    auto sealed = pooled.seal();
+    EXPECT_EQ(sealed.size(), 6u);
+    EXPECT_EQ(sealed.get_allocator().resource(), &resource);
+    EXPECT_GT(resource.allocations, 0u);
+}
+
+TEST(test_104, SpscQueueOrderAndBackpressure) {
+    SpscQueue<int> queue(3);
+    EXPECT_EQ(queue.capacity(), 4u);
+    int value = 0;
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.tryPush(i));
+    }
+    value = 4;
+    EXPECT_FALSE(queue.tryPush(value));
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(value, 0);
+
+    // A consumer thread sees every value, in order, through a full ring.
+    SpscQueue<std::unique_ptr<int>> transfer(8);
+    const int count = 100000;
+    std::thread producer([&transfer] {
+        for (int i = 0; i < count; ++i) {
+            ASSERT_TRUE(transfer.push(std::make_unique<int>(i)));
+        }
+        transfer.close();
+    });
+    std::unique_ptr<int> item;
+    int expected = 0;
+    while (transfer.pop(item)) {
+        ASSERT_EQ(*item, expected++);
+    }
+    producer.join();
+    EXPECT_EQ(expected, count);
+
+    // Cancel releases a producer stuck on a full queue.
+    SpscQueue<int> stuck(2);
+    std::thread blocked([&stuck] {
+        int pushed = 0;
+        while (stuck.push(pushed)) {
+            ++pushed;
+        }
+        EXPECT_EQ(pushed, 2);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    stuck.cancel();
+    blocked.join();
+    EXPECT_FALSE(stuck.pop(value));
+
+    // A consumer asleep past the spin budget wakes on push and on close.
+    SpscQueue<int> idle(2);
+    std::thread consumer([&idle] {
+        int received = 0;
+        EXPECT_TRUE(idle.pop(received));
+        EXPECT_EQ(received, 7);
+        EXPECT_FALSE(idle.pop(received));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_TRUE(idle.push(7));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    idle.close();
+    consumer.join();
+}
+
+TEST(test_105, FigurePipelineMatchesInMemoryPasses) {
+    std::string text = "# scene\n";
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> size(0.5, 4.0);
+    for (int i = 0; i < 20000; ++i) {
+        switch (i % 3) {
+            case 0: text += "R " + std::to_string(size(rng)) + " " + std::to_string(size(rng)) + " " + std::to_string(i) + " 1\n"; break;
+            case 1: text += "P " + std::to_string(size(rng)) + " " + std::to_string(-i) + " 2\n"; break;
+            default: text += "\nH " + std::to_string(size(rng)) + " 0 " + std::to_string(i); text += "\n"; break;
+        }
+    }
+    text += "H 1 0 0";  // no final newline
+    auto figures = parseFigures<double>(text);
+
+    FigurePipelineOptions options;
+    options.batchSize = 7;
+    options.queueBatches = 2;
+    options.readChunk = 1000;  // splits lines across reads
+    std::istringstream is(text);
+    auto totals = streamFigureTotals<double>(is, options);
+    EXPECT_EQ(totals.figures, figures.size());
+    EXPECT_EQ(totals.totalArea, calculateTotalArea(figures));
+    BoundingBox bounds;
+    size_t vertices = 0;
+    for (const auto &figure : figures) {
+        bounds.expand(figure->boundingBox());
+        vertices += figure->getVertices().size();
+    }
+    EXPECT_EQ(totals.vertices, vertices);
+    EXPECT_EQ(totals.bounds, bounds);
+
+    // Results arrive in input order.
+    std::istringstream again(text);
+    size_t index = 0;
+    runFigurePipeline<double>(again, [](const Figure<double> &figure) { return figure.calculateArea(); },
+        [&](double area) { ASSERT_EQ(area, figures[index++]->calculateArea()); }, options);
+    EXPECT_EQ(index, figures.size());
+
+    // A parse error deep in the stream keeps its line number.
+    std::istringstream broken(text.substr(0, text.find('\n', 50000) + 1) + "X 1 2\n" + text);
+    try {
+        streamFigureTotals<double>(broken, options);
+        FAIL() << "expected FigureParseError";
+    } catch (const FigureParseError &e) {
+        EXPECT_EQ(e.line(), countLines(text.substr(0, text.find('\n', 50000) + 1)));
+    }
+    // A line that never ends is rejected with its number, not buffered.
+    FigurePipelineOptions capped = options;
+    capped.readChunk = 64;
+    capped.maxLineLength = 100;
+    for (const std::string &tail : {std::string(5000, '1'), std::string(5000, '1') + "\n"}) {
+        std::istringstream endless("H 1 0 0\n\nR " + tail);
+        try {
+            streamFigureTotals<double>(endless, capped);
+            FAIL() << "expected FigureParseError";
+        } catch (const FigureParseError &e) {
+            EXPECT_EQ(e.line(), 3u);
+        }
+    }
+    // So does an exception from the aggregate stage.
+    std::istringstream aborted(text);
+    EXPECT_THROW(runFigurePipeline<double>(aborted, computeFigureMetrics<double>, [](const FigureMetrics &) {
+        throw std::runtime_error("stop");
+    }, options), std::runtime_error);
+}
+
+TEST(test_106, FigureCollectionTracksAggregates) {
+    FigureCollection<double> collection;
+    EXPECT_EQ(collection.totalArea(), 0.0);
+    EXPECT_TRUE(collection.extent().empty());
+    EXPECT_EQ(collection.centroid(), Point<double>(0.0, 0.0));
+
+    collection.push_back(make_shared<Rhombus<double>>(2.0, 4.0, 0.0, 0.0));
+    collection.push_back(make_shared<Hexagon<double>>(1.0, 10.0, 0.0));
+    collection.push_back(make_shared<Rhombus<double>>(6.0, 2.0, 0.0, 10.0));
+    collection.push_back(make_shared<CachedFigure<Pentagon<double>>>(1.0, -5.0, 0.0));
+    EXPECT_EQ(collection.countOfKind("rhombus"), 2u);
+    EXPECT_EQ(collection.countOfKind("hexagon"), 1u);
+    EXPECT_EQ(collection.countOfKind("pentagon"), 1u);
+    EXPECT_EQ(collection.countOfKind("square"), 0u);
+    EXPECT_NEAR(collection.totalArea(), calculateTotalArea(collection.figures()), 1e-12);
+    EXPECT_NEAR(collection.centroid().x(), 1.25, 1e-12);
+    EXPECT_NEAR(collection.centroid().y(), 2.5, 1e-12);
+
+    BoundingBox extent = collection.extent();
+    EXPECT_EQ(extent.maxX, 11.0);
+    EXPECT_EQ(extent.maxY, 11.0);
+    EXPECT_EQ(extent.minY, -2.0);
+
+    // Removing the figure on the far edge shrinks the extent.
+    collection.remove(2);
+    EXPECT_EQ(collection.extent().maxY, 2.0);
+    EXPECT_EQ(collection.countOfKind("rhombus"), 1u);
+    EXPECT_EQ(collection.size(), 3u);
+    EXPECT_EQ(collection[2]->kindName(), std::string("pentagon"));
+
+    collection.replace(0, make_shared<Hexagon<double>>(2.0, 0.0, 0.0));
+    EXPECT_EQ(collection.countOfKind("rhombus"), 0u);
+    EXPECT_EQ(collection.kindCounts().count("rhombus"), 0u);
+    EXPECT_EQ(collection.countOfKind("hexagon"), 2u);
+
+    // Mutations go through update(); the weighted centroid follows.
+    collection.update(1, [](Figure<double> &figure) { figure.translate(-10.0, 4.0); });
+    EXPECT_EQ(collection[1]->calculateCenter(), Point<double>(0.0, 4.0));
+    double weighted_y = 4.0 * Hexagon<double>(1.0, 0.0, 0.0).calculateArea() / collection.totalArea();
+    EXPECT_NEAR(collection.areaWeightedCentroid().y(), weighted_y, 1e-12);
+    EXPECT_NEAR(collection.totalArea(), calculateTotalArea(collection.figures()), 1e-12);
+
+    EXPECT_THROW(collection.remove(3), std::out_of_range);
+    EXPECT_THROW(collection.push_back(nullptr), std::invalid_argument);
+    collection.swap_remove(0);
+    collection.swap_remove(0);
+    collection.swap_remove(0);
+    EXPECT_TRUE(collection.empty());
+    EXPECT_TRUE(collection.kindCounts().empty());
+    EXPECT_TRUE(collection.extent().empty());
+}
+
+TEST(test_107, FigureCollectionAreaDoesNotDrift) {
+    // Tiny figures next to one large one, churned many times. Each tiny area
+    // is below half an ulp of the total, so a plain running sum never moves.
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> tiny(0.8e-4, 1.2e-4);
+    auto make = [&] { return make_shared<Rhombus<double>>(tiny(rng), tiny(rng), 0.0, 0.0); };
+    FigureCollection<double> collection;
+    collection.push_back(make_shared<Rhombus<double>>(1e4, 2e4, 0.0, 0.0));
+    double naive = collection.totalArea();
+    for (int i = 0; i < 2000; ++i) {
+        auto figure = make();
+        naive += figure->calculateArea();
+        collection.push_back(figure);
+    }
+    for (int round = 0; round < 50000; ++round) {
+        size_t index = 1 + rng() % (collection.size() - 1);
+        naive -= collection[index]->calculateArea();
+        collection.swap_remove(index);
+        auto figure = make();
+        naive += figure->calculateArea();
+        collection.push_back(figure);
+    }
+    double small = 0.0;
+    for (size_t i = 1; i < collection.size(); ++i) {
+        small += collection[i]->calculateArea();
+    }
+    double exact = 1e8 + small;
+    double ulp = std::nextafter(exact, 2e8) - exact;
+    EXPECT_NEAR(collection.totalArea(), exact, 2 * ulp);
+    EXPECT_GT(std::abs(naive - exact), 16 * ulp);
+
+    // Construction from an Array matches recompute() and calculateTotalArea.
+    auto figures = makeScatteredFigures(500, 3);
+    FigureCollection<double> built(figures);
+    EXPECT_NEAR(built.totalArea(), calculateTotalArea(figures), 1e-9 * calculateTotalArea(figures));
+    EXPECT_EQ(built.size(), 500u);
+
+    // An infinite figure makes the aggregates infinite while it is in and
+    // leaves no trace once it is removed.
+    FigureCollection<double> scene;
+    scene.push_back(make_shared<Rhombus<double>>(2.0, 4.0, 1.0, 1.0));
+    scene.push_back(make_shared<Hexagon<double>>(1.0, 3.0, 3.0));
+    double finite_area = scene.totalArea();
+    Point<double> finite_centroid = scene.areaWeightedCentroid();
+    scene.push_back(make_shared<Rhombus<double>>(INFINITY, 2.0, 0.0, 0.0));
+    EXPECT_EQ(scene.totalArea(), INFINITY);
+    EXPECT_EQ(scene.totalArea(), calculateTotalArea(scene.figures()));
+    scene.push_back(make_shared<Hexagon<double>>(1.0, INFINITY, 0.0));
+    EXPECT_EQ(scene.centroid().x(), INFINITY);
+    scene.push_back(make_shared<Hexagon<double>>(1.0, -INFINITY, 0.0));
+    EXPECT_TRUE(std::isnan(scene.centroid().x()));
+    EXPECT_TRUE(std::isnan(scene.areaWeightedCentroid().x()));
+    scene.remove(4);
+    scene.remove(3);
+    scene.remove(2);
+    EXPECT_EQ(scene.totalArea(), finite_area);
+    EXPECT_EQ(scene.totalArea(), calculateTotalArea(scene.figures()));
+    EXPECT_EQ(scene.areaWeightedCentroid(), finite_centroid);
+    EXPECT_EQ(scene.centroid(), Point<double>(2.0, 2.0));
+    BoundingBox bounds = scene[0]->boundingBox();
+    bounds.expand(scene[1]->boundingBox());
+    EXPECT_EQ(scene.extent(), bounds);
+}